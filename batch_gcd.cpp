@@ -0,0 +1,100 @@
+namespace command_line {
+    const char help_message[] =
+" [options] <public key>...\n"
+"Searches a collection of RSA public keys for moduli that share a prime factor,\n"
+"using Bernstein's batch GCD algorithm.\n"
+"\n"
+"Every key whose modulus shares a factor with some other modulus\n"
+"is printed, followed by the shared factor.\n"
+"If the entire modulus is shared (the same key appears twice),\n"
+"the modulus itself is printed.\n"
+"\n"
+"Options:\n"
+"--list <file>\n"
+"    Reads the names of the public key files from the given file,\n"
+"    one per line, in addition to the ones given in the command line.\n"
+"\n"
+"--threads <N>\n"
+"    Number of threads used to build the product and remainder trees.\n"
+"    Default: number of processors.\n"
+"\n"
+"--stats\n"
+"    Writes the instrumentation counters to the standard error at exit\n"
+"    (see instrument/instrument.hpp; needs a build with -DINSTRUMENT).\n"
+"\n"
+"--help\n"
+"    Displays this help and quit.\n"
+;
+} // namespace command_line
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <gmpxx.h>
+#include "cmdline/args.hpp"
+#include "instrument/instrument.hpp"
+#include "math/batch_gcd.hpp"
+#include "parallel/parallel_for.hpp"
+#include "protocols/rsa.hpp"
+
+namespace command_line {
+    std::vector< std::string > key_files;
+    unsigned threads = parallel::default_threads();
+
+    void parse( cmdline::args && args ) {
+        while( args.size() > 0 ) {
+            std::string arg = args.next();
+            if( arg == "--list" ) {
+                std::ifstream list( args.next() );
+                std::string name;
+                while( std::getline( list, name ) )
+                    if( name != "" )
+                        key_files.push_back( name );
+                continue;
+            }
+            if( arg == "--threads" ) {
+                args.range( 1 ) >> threads;
+                continue;
+            }
+            if( arg == "--stats" ) {
+                instrument::report_at_exit();
+                continue;
+            }
+            if( arg == "--help" ) {
+                std::cout << "Usage: " << args.program_name() << help_message;
+                std::exit( 0 );
+            }
+            key_files.push_back( arg );
+        }
+    }
+} // namespace command_line
+
+int main( int argc, char ** argv ) {
+    command_line::parse( cmdline::args( argc, argv ) );
+
+    std::vector< mpz_class > moduli;
+    for( const std::string & name : command_line::key_files ) {
+        std::ifstream file( name );
+        rsa::public_key< mpz_class > key;
+        if( !(file >> key) ) {
+            std::cerr << "Could not read a public key from " << name << '\n';
+            return 1;
+        }
+        moduli.push_back( key.n );
+    }
+
+    auto gcds = math::batch_gcd( moduli, command_line::threads );
+
+    int weak_keys = 0;
+    for( std::size_t i = 0; i < gcds.size(); i++ )
+        if( gcds[i] != 1 ) {
+            std::cout << command_line::key_files[i] << ": " << gcds[i] << '\n';
+            weak_keys++;
+        }
+
+    std::cerr << weak_keys << " of " << moduli.size()
+        << " moduli share factors with another modulus.\n";
+    return 0;
+}
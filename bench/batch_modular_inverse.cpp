@@ -0,0 +1,45 @@
+/* Compares math::batch_modular_inverse against
+ * independent calls to math::modular_inverse.
+ *
+ * Usage: batch_modular_inverse [modulus bits]
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <gmpxx.h>
+#include "bench/bench.hpp"
+#include "math/algo.hpp"
+#include "math/generate_primes.hpp"
+#include "random/xorshift.hpp"
+
+int main( int argc, char ** argv ) {
+    int bits = 1024;
+    if( argc > 1 )
+        sscanf( argv[1], "%d", &bits );
+
+    rng::xorshift rng;
+    mpz_class n = math::generate_prime_number( rng, bits, 30 );
+
+    std::cout << "modulus bits: " << bits << '\n'
+        << "k\tbatch inv/s\tsingle inv/s\tspeedup\n";
+    for( int k : {1, 10, 100, 1000, 10000} ) {
+        std::vector< mpz_class > values( k );
+        for( auto & value : values )
+            value = rng::gmp_generate( rng, bits ) % n;
+
+        std::vector< mpz_class > work;
+        double batch = bench::seconds_per_call( [&]() {
+            work = values;
+            math::batch_modular_inverse( work, n );
+        });
+        double single = bench::seconds_per_call( [&]() {
+            for( std::size_t i = 0; i < values.size(); i++ )
+                work[i] = math::modular_inverse( values[i], n );
+        });
+
+        std::cout << k << '\t' << k / batch << '\t' << k / single
+            << '\t' << single / batch << '\n';
+    }
+    return 0;
+}
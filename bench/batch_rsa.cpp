@@ -0,0 +1,65 @@
+/* Compares Fiat's batch RSA decryption (protocols/batch_rsa.hpp)
+ * with decrypting each ciphertext on its own,
+ * both with rsa::private_key::decrypt and with the CRT.
+ * The exponents are the first b odd primes.
+ *
+ * Usage: batch_rsa [key size]
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <gmpxx.h>
+#include "bench/bench.hpp"
+#include "protocols/batch_rsa.hpp"
+#include "protocols/rsa.hpp"
+#include "random/gmp_adapter.hpp"
+#include "random/xorshift.hpp"
+
+int main( int argc, char ** argv ) {
+    int key_size = 2048;
+    if( argc > 1 )
+        sscanf( argv[1], "%d", &key_size );
+
+    rng::xorshift rng;
+    auto all_exponents = rsa::batch_exponents( 16 );
+    mpz_class product = 1;
+    for( const auto & e : all_exponents )
+        product *= e;
+    auto primes = rsa::generate_key_primes( rng, key_size, product );
+
+    std::cout << "key size: " << key_size << '\n'
+        << "b\tbatch dec/s\tsingle dec/s\tCRT dec/s\tspeedup over single\n";
+    for( std::size_t b : {1, 2, 4, 8, 16} ) {
+        std::vector< mpz_class > exponents( all_exponents.begin(), all_exponents.begin() + b );
+        rsa::batch_private_key< mpz_class > key( primes.first, primes.second, exponents );
+        std::vector< mpz_class > plaintexts, ciphertexts;
+        std::vector< rsa::private_key< mpz_class > > single;
+        for( std::size_t i = 0; i < b; i++ ) {
+            plaintexts.push_back( rng::gmp_generate( rng, key_size - 2 ) );
+            ciphertexts.push_back( key.public_key_at( i ).encrypt( plaintexts.back() ) );
+            single.push_back( rsa::build_private_key( primes.first, primes.second, exponents[i] ) );
+        }
+
+        bool ok = true;
+        double batch = bench::seconds_per_call( [&]() {
+            ok &= key.decrypt( ciphertexts ) == plaintexts;
+        }) / b;
+        std::size_t i = 0;
+        double plain = bench::seconds_per_call( [&]() {
+            ok &= single[i % b].decrypt( ciphertexts[i % b] ) == plaintexts[i % b];
+            i++;
+        });
+        double crt = bench::seconds_per_call( [&]() {
+            ok &= key.decrypt_one( ciphertexts[i % b], i % b ) == plaintexts[i % b];
+            i++;
+        });
+        if( !ok ) {
+            std::cout << "wrong decryption for b = " << b << '\n';
+            return 1;
+        }
+        std::cout << b << '\t' << 1 / batch << "\t\t" << 1 / plain << "\t\t"
+            << 1 / crt << "\t\t" << plain / batch << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,299 @@
+#ifndef BENCH_BENCH_HPP
+#define BENCH_BENCH_HPP
+
+/* Small helpers for timing the programs in this directory.
+ *
+ * seconds_per_call is the quick measurement used by the comparison programs.
+ *
+ * bench::suite is the harness of bench/kernels: each benchmark is warmed up
+ * and then measured in several repetitions; the distribution of the
+ * repetitions gives the percentiles, so that noise can be told apart
+ * from real changes. The results are written as JSON, in a fixed format
+ * that read_json understands, so that two runs can be compared
+ * (see bench/compare.cpp).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+    /* Calls f repeatedly, for at least min_seconds,
+     * and returns the average time of each call, in seconds.
+     */
+    template< typename F >
+    double seconds_per_call( F f, double min_seconds = 0.5 );
+
+    struct options {
+        double warmup_seconds = 0.1;   // Discarded calls before the repetitions
+        double min_seconds = 0.05;     // Minimum duration of each repetition
+        unsigned repetitions = 10;
+    };
+
+    /* Measurements of a single benchmark.
+     * A repetition calls the benchmark several times;
+     * its sample is the average time of one operation, in seconds.
+     */
+    struct result {
+        std::string name;
+        std::vector< double > samples; // Sorted
+
+        /* Time per operation below which lie p percent
+         * of the repetitions (nearest rank); 0 if there are none.
+         */
+        double percentile( double p ) const;
+        double median() const { return percentile( 50 ); }
+        double mean() const;
+        double ops_per_second() const;
+    };
+
+    /* Measures f with the given options.
+     * Each call of f counts as ops operations.
+     */
+    template< typename F >
+    result measure( std::string name, F f, const options & = options(), double ops = 1 );
+
+    /* Set of benchmarks run by one program.
+     * Only the benchmarks whose names contain filter are run;
+     * each result is written to out (if not null) as soon as it is known.
+     */
+    class suite {
+    public:
+        explicit suite( options opt = options(), std::string filter = "",
+            std::ostream * out = &std::cout );
+
+        // Whether the benchmark with this name passes the filter.
+        bool selected( const std::string & name ) const {
+            return name.find( filter ) != std::string::npos;
+        }
+
+        template< typename F >
+        void run( const std::string & name, F f, double ops = 1 );
+
+        const std::vector< result > & results() const { return list; }
+
+    private:
+        options opt;
+        std::string filter;
+        std::ostream * out;
+        std::vector< result > list;
+    };
+
+    /* Writes the results as a JSON document:
+     *  {
+     *    "benchmarks": [
+     *      {"name": "...", "repetitions": 10, "median": ..., "p10": ...,
+     *       "p90": ..., "min": ..., "max": ..., "mean": ..., "ops_per_second": ...},
+     *      ...
+     *    ]
+     *  }
+     * with one benchmark per line, in the order they were run.
+     * Times are in seconds per operation.
+     * The samples themselves are not written.
+     */
+    void write_json( std::ostream &, const std::vector< result > & );
+
+    /* Summary of a benchmark as read back from write_json's output.
+     */
+    struct summary {
+        std::string name;
+        double median = 0, p10 = 0, p90 = 0;
+    };
+
+    /* Reads the summaries written by write_json.
+     * Unknown keys are ignored; returns an empty list if the input
+     * is not in the expected format.
+     */
+    std::vector< summary > read_json( std::istream & );
+
+    /* A benchmark present in two runs.
+     * change is the relative change of the median time:
+     * positive means that the new run is slower.
+     * It is a regression if the change exceeds the threshold
+     * and the two runs' p10-p90 ranges do not overlap.
+     */
+    struct comparison {
+        std::string name;
+        double old_median, new_median;
+        double change;
+        bool regression;
+    };
+
+    // Compares the benchmarks in both runs; threshold is a fraction (0.05 = 5%).
+    std::vector< comparison > compare(
+        const std::vector< summary > & old_run,
+        const std::vector< summary > & new_run,
+        double threshold
+    );
+
+// Implementation
+
+    template< typename F >
+    double seconds_per_call( F f, double min_seconds ) {
+        using clock = std::chrono::steady_clock;
+        auto start = clock::now();
+        long calls = 0;
+        double elapsed;
+        do {
+            f();
+            calls++;
+            elapsed = std::chrono::duration<double>( clock::now() - start ).count();
+        } while( elapsed < min_seconds );
+        return elapsed / calls;
+    }
+
+    inline double result::percentile( double p ) const {
+        if( samples.empty() )
+            return 0;
+        std::size_t rank = std::ceil( p / 100 * samples.size() );
+        return samples[rank == 0 ? 0 : std::min( rank, samples.size() ) - 1];
+    }
+
+    inline double result::mean() const {
+        double sum = 0;
+        for( double s : samples )
+            sum += s;
+        return samples.empty() ? 0 : sum / samples.size();
+    }
+
+    inline double result::ops_per_second() const {
+        return median() > 0 ? 1 / median() : 0;
+    }
+
+    template< typename F >
+    result measure( std::string name, F f, const options & opt, double ops ) {
+        result r;
+        r.name = std::move( name );
+        if( opt.warmup_seconds > 0 )
+            seconds_per_call( f, opt.warmup_seconds );
+        for( unsigned i = 0; i < std::max( opt.repetitions, 1u ); i++ )
+            r.samples.push_back( seconds_per_call( f, opt.min_seconds ) / ops );
+        std::sort( r.samples.begin(), r.samples.end() );
+        return r;
+    }
+
+    inline suite::suite( options opt, std::string filter, std::ostream * out ) :
+        opt( opt ),
+        filter( std::move(filter) ),
+        out( out )
+    {}
+
+    template< typename F >
+    void suite::run( const std::string & name, F f, double ops ) {
+        if( !selected( name ) )
+            return;
+        list.push_back( measure( name, f, opt, ops ) );
+        const result & r = list.back();
+        if( out ) {
+            char line[256];
+            std::snprintf( line, sizeof line, "%-32s %12.4g ops/s  median %10.4g s  p10 %10.4g  p90 %10.4g\n",
+                r.name.c_str(), r.ops_per_second(), r.median(), r.percentile( 10 ), r.percentile( 90 ) );
+            *out << line << std::flush;
+        }
+    }
+
+    inline void write_json( std::ostream & os, const std::vector< result > & results ) {
+        os << "{\n  \"benchmarks\": [";
+        char buffer[512];
+        for( std::size_t i = 0; i < results.size(); i++ ) {
+            const result & r = results[i];
+            std::string name;
+            for( char c : r.name ) {
+                if( c == '"' || c == '\\' )
+                    name += '\\';
+                name += c;
+            }
+            std::snprintf( buffer, sizeof buffer,
+                "%s\n    {\"name\": \"%s\", \"repetitions\": %zu, \"median\": %.6e, "
+                "\"p10\": %.6e, \"p90\": %.6e, \"min\": %.6e, \"max\": %.6e, "
+                "\"mean\": %.6e, \"ops_per_second\": %.6e}",
+                i == 0 ? "" : ",", name.c_str(), r.samples.size(), r.median(),
+                r.percentile( 10 ), r.percentile( 90 ), r.percentile( 0 ), r.percentile( 100 ),
+                r.mean(), r.ops_per_second() );
+            os << buffer;
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    inline std::vector< summary > read_json( std::istream & is ) {
+        std::string text( (std::istreambuf_iterator<char>( is )), std::istreambuf_iterator<char>() );
+        std::vector< summary > list;
+        std::size_t pos = text.find( "\"benchmarks\"" );
+        if( pos == std::string::npos )
+            return list;
+
+        // Reads the string that starts at text[pos], which must be a '"'.
+        auto read_string = [&]( std::string & s ) {
+            s.clear();
+            for( pos++; pos < text.size() && text[pos] != '"'; pos++ ) {
+                if( text[pos] == '\\' )
+                    pos++;
+                if( pos < text.size() )
+                    s += text[pos];
+            }
+            pos++;
+        };
+
+        while( (pos = text.find_first_of( "{]", pos )) != std::string::npos && text[pos] == '{' ) {
+            summary s;
+            pos++;
+            while( pos < text.size() && text[pos] != '}' ) {
+                if( text[pos] != '"' ) {
+                    pos++;
+                    continue;
+                }
+                std::string key;
+                read_string( key );
+                pos = text.find_first_not_of( " \t\n:", pos );
+                if( pos == std::string::npos )
+                    return {};
+                if( text[pos] == '"' ) {
+                    std::string value;
+                    read_string( value );
+                    if( key == "name" )
+                        s.name = value;
+                    continue;
+                }
+                double value = std::strtod( text.c_str() + pos, nullptr );
+                if( key == "median" )
+                    s.median = value;
+                else if( key == "p10" )
+                    s.p10 = value;
+                else if( key == "p90" )
+                    s.p90 = value;
+                pos = text.find_first_of( ",}", pos );
+                if( pos == std::string::npos )
+                    return {};
+            }
+            list.push_back( s );
+        }
+        return list;
+    }
+
+    inline std::vector< comparison > compare(
+        const std::vector< summary > & old_run,
+        const std::vector< summary > & new_run,
+        double threshold
+    ) {
+        std::vector< comparison > list;
+        for( const summary & n : new_run )
+            for( const summary & o : old_run )
+                if( o.name == n.name && o.median > 0 ) {
+                    double change = n.median / o.median - 1;
+                    list.push_back( { n.name, o.median, n.median, change,
+                        change > threshold && n.p10 > o.p90 } );
+                    break;
+                }
+        return list;
+    }
+
+} // namespace bench
+
+#endif // BENCH_BENCH_HPP
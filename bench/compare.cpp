@@ -0,0 +1,54 @@
+/* Compares two runs of bench/kernels, written with --json.
+ * Lists every benchmark present in both runs with the change
+ * of its median time, and flags as regressions the benchmarks
+ * that became slower by more than the threshold
+ * (and whose p10-p90 ranges do not overlap).
+ *
+ * Exits with status 1 if there is a regression.
+ *
+ * Usage: compare <old.json> <new.json> [threshold in percent, default 5]
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include "bench/bench.hpp"
+
+int main( int argc, char ** argv ) {
+    if( argc < 3 ) {
+        std::cerr << "Usage: " << argv[0] << " <old.json> <new.json> [threshold %]\n";
+        return 2;
+    }
+    double threshold = 5;
+    if( argc > 3 )
+        sscanf( argv[3], "%lf", &threshold );
+
+    std::vector< bench::summary > runs[2];
+    for( int i = 0; i < 2; i++ ) {
+        std::ifstream file( argv[i + 1] );
+        runs[i] = bench::read_json( file );
+        if( runs[i].empty() ) {
+            std::cerr << "No benchmarks in " << argv[i + 1] << '\n';
+            return 2;
+        }
+    }
+
+    int regressions = 0;
+    char line[256];
+    for( const auto & c : bench::compare( runs[0], runs[1], threshold / 100 ) ) {
+        std::snprintf( line, sizeof line, "%-32s %10.4g s -> %10.4g s  %+7.1f%%%s\n",
+            c.name.c_str(), c.old_median, c.new_median, c.change * 100,
+            c.regression ? "  REGRESSION" : "" );
+        std::cout << line;
+        regressions += c.regression;
+    }
+    for( const auto & n : runs[1] ) {
+        bool found = false;
+        for( const auto & o : runs[0] )
+            found = found || o.name == n.name;
+        if( !found )
+            std::cout << n.name << ": only in " << argv[2] << '\n';
+    }
+    std::cout << regressions << " regression(s) above " << threshold << "%\n";
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,53 @@
+/* Compares Diffie-Hellman handshakes with private numbers as wide as p
+ * and with private numbers below the order q of a prime-order subgroup,
+ * with and without checking that the partner's number lies in the subgroup.
+ * Each handshake is one side of an exchange: generating the private
+ * and public numbers, and computing the common secret.
+ *
+ * Usage: dh_handshake [bits of p] [bits of q]
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <gmpxx.h>
+#include "bench/bench.hpp"
+#include "math/generate_primes.hpp"
+#include "protocols/diffie_hellman.hpp"
+#include "random/xorshift.hpp"
+
+int main( int argc, char ** argv ) {
+    int bits = 2048, order_bits = 256;
+    if( argc > 1 )
+        sscanf( argv[1], "%d", &bits );
+    if( argc > 2 )
+        sscanf( argv[2], "%d", &order_bits );
+
+    rng::xorshift rng;
+    auto group = math::generate_subgroup_prime( rng, bits, order_bits, 30 );
+    std::cout << "p: " << bits << " bits, q: " << order_bits << " bits\n";
+
+    protocol::diffie_hellman<> partner( group.prime, group.generator, group.order );
+    partner.generate_private_number( rng );
+    mpz_class partner_public = partner.get_public_number();
+
+    auto handshakes_per_second = [&]( mpz_class order, bool check ) {
+        protocol::diffie_hellman<> dh( group.prime, group.generator, order );
+        bool ok = true;
+        double seconds = bench::seconds_per_call( [&]() {
+            dh.generate_private_number( rng );
+            ok &= dh.set_partner_public_number( partner_public, check );
+        }, 1.0 );
+        if( !ok )
+            std::cout << "the partner's number was rejected\n";
+        return 1 / seconds;
+    };
+
+    double full = handshakes_per_second( 0, false );
+    double short_exponent = handshakes_per_second( group.order, false );
+    double checked = handshakes_per_second( group.order, true );
+    std::cout << "mode\t\t\thandshakes/s\tspeedup\n"
+        << "full exponent\t\t" << full << "\t\t1\n"
+        << "subgroup\t\t" << short_exponent << "\t\t" << short_exponent / full << '\n'
+        << "subgroup, checked\t" << checked << "\t\t" << checked / full << '\n';
+    return 0;
+}
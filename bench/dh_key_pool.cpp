@@ -0,0 +1,74 @@
+/* Measures the critical path of a Diffie-Hellman handshake
+ * (obtaining a key pair and computing the common secret)
+ * with and without a warm protocol::dh_key_pool,
+ * in a group with a 256-bit subgroup order.
+ * Then drains the pool with one refill thread running,
+ * and reports the hit rate and refill rate under that load.
+ *
+ * Usage: dh_key_pool [bits of p] [pool capacity]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <gmpxx.h>
+#include "bench/bench.hpp"
+#include "math/generate_primes.hpp"
+#include "protocols/dh_key_pool.hpp"
+#include "random/xorshift.hpp"
+
+int main( int argc, char ** argv ) {
+    int bits = 2048, capacity = 1024;
+    if( argc > 1 )
+        sscanf( argv[1], "%d", &bits );
+    if( argc > 2 )
+        sscanf( argv[2], "%d", &capacity );
+
+    rng::xorshift rng;
+    auto group = math::generate_subgroup_prime( rng, bits, 256, 30 );
+    protocol::diffie_hellman<> partner( group.prime, group.generator, group.order );
+    partner.generate_private_number( rng );
+    mpz_class partner_public = partner.get_public_number();
+
+    double plain = bench::seconds_per_call( [&]() {
+        protocol::diffie_hellman<> dh( group.prime, group.generator, group.order );
+        dh.generate_private_number( rng );
+        dh.set_partner_public_number( partner_public );
+    });
+
+    protocol::dh_key_pool pool( group.prime, group.generator, group.order,
+        capacity, 1, rng );
+    std::size_t size = pool.stats().capacity;
+    while( pool.stats().ready < size )
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+
+    // Only the pool's contents are timed; the misses come afterwards.
+    auto start = std::chrono::steady_clock::now();
+    for( std::size_t i = 0; i < size; i++ ) {
+        protocol::diffie_hellman<> dh( group.prime, group.generator, group.order );
+        pool.prepare( dh, rng );
+        dh.set_partner_public_number( partner_public );
+    }
+    double pooled = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start ).count() / size;
+
+    // Sustained load: twice the pool's size, back to back.
+    for( std::size_t i = 0; i < 2 * size; i++ ) {
+        protocol::diffie_hellman<> dh( group.prime, group.generator, group.order );
+        pool.prepare( dh, rng );
+        dh.set_partner_public_number( partner_public );
+    }
+    auto stats = pool.stats();
+
+    std::cout << "p: " << bits << " bits, q: 256 bits, pool capacity: " << size << '\n'
+        << "critical path without pool (ms):\t" << plain * 1000 << '\n'
+        << "critical path with warm pool (ms):\t" << pooled * 1000 << '\n'
+        << "speedup:\t\t\t\t" << plain / pooled << '\n'
+        << "after " << 3 * size << " handshakes:\n"
+        << "  hit rate:\t\t\t\t" << stats.hit_rate() << '\n'
+        << "  refill rate (pairs/s):\t\t" << stats.refill_rate() << '\n'
+        << "  occupancy:\t\t\t\t" << stats.occupancy() << '\n'
+        << "  lowest occupancy:\t\t\t" << stats.lowest_ready << '\n';
+    return 0;
+}
@@ -0,0 +1,56 @@
+/* Compares math::fixed_base with math::pow_mod
+ * for random exponents below a random odd modulus,
+ * and reports the time needed to build each table.
+ *
+ * Usage: fixed_base [modulus bits]
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <gmpxx.h>
+#include "bench/bench.hpp"
+#include "math/algo.hpp"
+#include "math/fixed_base.hpp"
+#include "random/gmp_adapter.hpp"
+#include "random/xorshift.hpp"
+
+int main( int argc, char ** argv ) {
+    int bits = 2048;
+    if( argc > 1 )
+        sscanf( argv[1], "%d", &bits );
+
+    rng::xorshift rng;
+    mpz_class n = rng::gmp_generate( rng, bits ) | 1;
+    mpz_class g = rng::gmp_generate( rng, bits ) % n;
+    std::vector< mpz_class > exponents( 64 );
+    for( auto & e : exponents )
+        e = rng::gmp_generate( rng, bits ) % n;
+
+    std::size_t i = 0;
+    mpz_class sink;
+    double plain = bench::seconds_per_call( [&]() {
+        sink += math::pow_mod( g, exponents[i++ % exponents.size()], n );
+    });
+    std::cout << "modulus bits: " << bits << '\n'
+        << "pow_mod: " << 1 / plain << " pow/s\n"
+        << "window\ttable entries\tbuild s\tpow/s\tspeedup\n";
+
+    for( unsigned w = 2; w <= 8; w++ ) {
+        math::fixed_base< mpz_class > f;
+        double build = bench::seconds_per_call( [&]() {
+            f = math::fixed_base< mpz_class >( g, n, bits, w );
+        }, 0 );
+        for( const auto & e : exponents )
+            if( f.pow( e ) != math::pow_mod( g, e, n ) ) {
+                std::cout << "wrong result for window " << w << '\n';
+                return 1;
+            }
+        double fixed = bench::seconds_per_call( [&]() {
+            sink += f.pow( exponents[i++ % exponents.size()] );
+        });
+        std::cout << w << '\t' << (bits + w - 1) / w * ((1 << w) - 1) << "\t\t"
+            << build << '\t' << 1 / fixed << '\t' << plain / fixed << '\n';
+    }
+    return sink == 0; // Keep the results alive
+}
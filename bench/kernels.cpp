@@ -0,0 +1,237 @@
+namespace command_line {
+    const char help_message[] =
+" [options]\n"
+"Microbenchmarks of the hot kernels of this repository:\n"
+"modular exponentiation, gcd, the Fermat test, random number generation,\n"
+"trial division, Pollard's rho and the generation of Pinch noticeboards.\n"
+"\n"
+"Every benchmark is warmed up and then measured in several repetitions;\n"
+"the median, the 10th and the 90th percentiles of the time per operation\n"
+"are reported. The inputs come from fixed seeds,\n"
+"so that runs can be compared with bench/compare.\n"
+"\n"
+"Options:\n"
+"--json <file>\n"
+"    Also write the results to the file, in JSON.\n"
+"\n"
+"--filter <text>\n"
+"    Only run the benchmarks whose names contain the text.\n"
+"\n"
+"--repetitions <N>\n"
+"    Number of measured repetitions of each benchmark.\n"
+"    Default: 10.\n"
+"\n"
+"--min-time <milliseconds>\n"
+"    Minimum duration of each repetition.\n"
+"    Default: 50.\n"
+"\n"
+"--warmup <milliseconds>\n"
+"    Time spent running each benchmark before measuring it.\n"
+"    Default: 100.\n"
+"\n"
+"--stats\n"
+"    Writes the instrumentation counters to the standard error at exit\n"
+"    (see instrument/instrument.hpp; needs a build with -DINSTRUMENT).\n"
+"\n"
+"--help\n"
+"    Displays this help and quit.\n"
+;
+} // namespace command_line
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gmpxx.h>
+#include "bench/bench.hpp"
+#include "cmdline/args.hpp"
+#include "instrument/instrument.hpp"
+#include "math/algo.hpp"
+#include "math/factor.hpp"
+#include "math/fixed_base.hpp"
+#include "math/generate_primes.hpp"
+#include "math/primality.hpp"
+#include "math/primitive_root.hpp"
+#include "pinch/dealer_information.hpp"
+#include "random/gmp_adapter.hpp"
+#include "random/xorshift.hpp"
+
+namespace command_line {
+    std::string json;
+    std::string filter;
+    unsigned repetitions = 10;
+    unsigned min_time = 50;
+    unsigned warmup = 100;
+
+    void parse( cmdline::args && args ) {
+        while( args.size() > 0 ) {
+            std::string arg = args.next();
+            if( arg == "--json" ) {
+                json = args.next();
+                continue;
+            }
+            if( arg == "--filter" ) {
+                filter = args.next();
+                continue;
+            }
+            if( arg == "--repetitions" ) {
+                args.range( 1 ) >> repetitions;
+                continue;
+            }
+            if( arg == "--min-time" ) {
+                args.range( 1 ) >> min_time;
+                continue;
+            }
+            if( arg == "--warmup" ) {
+                args.range( 0 ) >> warmup;
+                continue;
+            }
+            if( arg == "--stats" ) {
+                instrument::report_at_exit();
+                continue;
+            }
+            if( arg == "--help" ) {
+                std::cout << "Usage: " << args.program_name() << help_message;
+                std::exit( 0 );
+            }
+            std::cerr << args.program_name() << ": Unknown option " << arg << '\n';
+            std::exit( 1 );
+        }
+    }
+} // namespace command_line
+
+namespace {
+    // Consumes benchmark results, so that the compiler cannot discard them.
+    mpz_class sink;
+    std::uint64_t word_sink;
+}
+
+int main( int argc, char ** argv ) {
+    command_line::parse( cmdline::args( argc, argv ) );
+
+    bench::options opt;
+    opt.repetitions = command_line::repetitions;
+    opt.min_seconds = command_line::min_time / 1000.0;
+    opt.warmup_seconds = command_line::warmup / 1000.0;
+    bench::suite suite( opt, command_line::filter );
+
+    /* The inputs come from their own generator, so they do not depend
+     * on how many times the timed code called rng.
+     */
+    rng::xorshift input( 1, 2, 3, 4 ), rng( 5, 6, 7, 8 );
+
+    suite.run( "xorshift", [&]() {
+        for( int i = 0; i < 1000; i++ )
+            word_sink += rng();
+    }, 1000 );
+
+    for( int bits : {512, 2048} )
+        suite.run( "gmp_generate/" + std::to_string( bits ), [&]() {
+            sink += rng::gmp_generate( rng, bits );
+        });
+
+    for( int bits : {512, 1024, 2048, 3072} ) {
+        mpz_class n = rng::gmp_generate( input, bits ) | 1;
+        mpz_class base = rng::gmp_generate( input, bits ) % n;
+        mpz_class exponent = rng::gmp_generate( input, bits );
+        suite.run( "pow_mod/" + std::to_string( bits ), [&]() {
+            sink += math::pow_mod( base, exponent, n );
+        });
+    }
+    {
+        // Products of two residues must fit in a long long.
+        long long n = 2147483647, base = 123456789, exponent = 987654321987LL;
+        suite.run( "pow_mod/long_long", [&]() {
+            word_sink += math::pow_mod( base, exponent, n );
+        });
+    }
+    {
+        int bits = 2048;
+        mpz_class n = rng::gmp_generate( input, bits ) | 1;
+        mpz_class g = rng::gmp_generate( input, bits ) % n;
+        mpz_class exponent = rng::gmp_generate( input, bits );
+        math::fixed_base< mpz_class > table( g, n, bits );
+        suite.run( "fixed_base/2048", [&]() {
+            sink += table.pow( exponent );
+        });
+        std::vector< std::pair< mpz_class, mpz_class > > terms;
+        for( int i = 0; i < 2; i++ )
+            terms.push_back( {rng::gmp_generate( input, bits ) % n, rng::gmp_generate( input, bits )} );
+        suite.run( "multi_pow_mod/2048/k=2", [&]() {
+            sink += math::multi_pow_mod( terms, n );
+        });
+    }
+
+    for( int bits : {64, 2048} ) {
+        mpz_class a = rng::gmp_generate( input, bits ), b = rng::gmp_generate( input, bits );
+        suite.run( "gcd/mpz/" + std::to_string( bits ), [&]() {
+            sink += math::gcd( a, b );
+        });
+    }
+    {
+        std::vector< long long > values;
+        for( int i = 0; i < 64; i++ )
+            values.push_back( (long long) input() << 31 ^ input() );
+        suite.run( "gcd/long_long", [&]() {
+            for( std::size_t i = 0; i + 1 < values.size(); i++ )
+                word_sink += math::gcd( values[i], values[i+1] );
+        }, values.size() - 1 );
+    }
+
+    for( int bits : {512, 1024, 2048} ) {
+        rng::xorshift search( 5, 6, 7, 8 );
+        mpz_class prime = math::generate_prime_number( search, bits, 10 );
+        suite.run( "fermat/" + std::to_string( bits ) + "/trials=10", [&]() {
+            word_sink += math::primality::fermat( prime, rng, 10 );
+        });
+    }
+
+    {
+        // No factor in the prime list, so the whole list is scanned.
+        rng::xorshift search( 9, 10, 11, 12 );
+        mpz_class p = math::generate_prime_number( search, 40, 10 );
+        mpz_class q = math::generate_prime_number( search, 40, 10 );
+        mpz_class product = p * q;
+        suite.run( "trial_division/80", [&]() {
+            mpz_class n = product;
+            sink += math::factor::trial_division( n ).size();
+        });
+
+        for( int bits : {24, 32} ) {
+            p = math::generate_prime_number( search, bits, 10 );
+            q = math::generate_prime_number( search, bits, 10 );
+            product = p * q;
+            suite.run( "pollard_rho/" + std::to_string( 2 * bits ), [&]() {
+                sink += math::factor::pollard_rho( product, mpz_class( 2 ),
+                    rng::xorshift( 1, 2, 3, 4 ) ).size();
+            });
+        }
+    }
+
+    for( int bits : {512, 1024} ) {
+        std::string name = "generate_noticeboard/" + std::to_string( bits ) + "/C(8,3)";
+        if( !suite.selected( name ) )
+            continue; // Creating the dealer alone takes a while
+        rng::xorshift setup( 13, 14, 15, 16 );
+        auto prime = math::generate_factored_prime( setup, bits, 64, 25 );
+        pinch::dealer_information< mpz_class > dealer;
+        dealer.prime = prime.prime;
+        dealer.generator = math::primitive_root_modulo_p( prime.prime, prime.factors );
+        dealer.issue_shares( 8, setup );
+        suite.run( name, [&]() {
+            sink += dealer.generate_noticeboard( mpz_class( 42 ), 3, rng ).groups.size();
+        });
+    }
+
+    if( !command_line::json.empty() ) {
+        std::ofstream file( command_line::json );
+        bench::write_json( file, suite.results() );
+        if( !file ) {
+            std::cerr << "Could not write " << command_line::json << '\n';
+            return 1;
+        }
+    }
+    return sink == 0 && word_sink == 0;
+}
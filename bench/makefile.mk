@@ -0,0 +1,38 @@
+BENCHDIR := $(dir $(lastword $(MAKEFILE_LIST)))
+
+BENCHSRC := $(shell find $(BENCHDIR) -name "*.cpp")
+
+prog += $(BENCHSRC:.cpp=)
+src += $(BENCHSRC)
+dep += $(BENCHSRC:.cpp=.dep.mk)
+
+# Timings of unoptimized code say little about the optimized one,
+# so the benchmarks are always optimized, whatever CXXFLAGS says.
+$(BENCHSRC:.cpp=.o): ALL_CXXFLAGS += -O2 -DNDEBUG
+
+# make bench runs the kernel microbenchmarks and writes them to BENCH_JSON.
+# If BENCH_BASELINE names a previous run, the two are compared,
+# and make fails if some benchmark became slower by more than
+# BENCH_THRESHOLD percent. BENCH_ARGS is passed to bench/kernels.
+BENCH_JSON ?= bench.json
+BENCH_BASELINE ?=
+BENCH_THRESHOLD ?= 5
+BENCH_ARGS ?=
+
+.PHONY: bench
+bench: $(BENCHDIR)kernels $(BENCHDIR)compare
+	$(BENCHDIR)kernels --json $(BENCH_JSON) $(BENCH_ARGS)
+ifneq ($(BENCH_BASELINE),)
+	$(BENCHDIR)compare $(BENCH_BASELINE) $(BENCH_JSON) $(BENCH_THRESHOLD)
+endif
+
+
+.PHONY: bench-clean bench-mostlyclean
+
+mostlyclean: bench-mostlyclean
+bench-mostlyclean:
+	find $(BENCHDIR) -name "*.o" -exec rm {} +
+
+clean: bench-clean
+bench-clean: bench-mostlyclean
+	rm -f $(BENCHSRC:.cpp=) $(BENCH_JSON)
@@ -0,0 +1,55 @@
+/* Compares math::multi_pow_mod with separate math::pow_mod calls
+ * followed by multiplications, for k (base, exponent) pairs.
+ *
+ * Usage: multi_pow_mod [bits of the modulus] [bits of the exponents]
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <gmpxx.h>
+#include "bench/bench.hpp"
+#include "math/algo.hpp"
+#include "random/gmp_adapter.hpp"
+#include "random/xorshift.hpp"
+
+int main( int argc, char ** argv ) {
+    int bits = 2048, exponent_bits = 256;
+    if( argc > 1 )
+        sscanf( argv[1], "%d", &bits );
+    if( argc > 2 )
+        sscanf( argv[2], "%d", &exponent_bits );
+
+    rng::xorshift rng;
+    mpz_class n = rng::gmp_generate( rng, bits ) | 1;
+    std::cout << "modulus: " << bits << " bits, exponents: " << exponent_bits << " bits\n"
+        << "k\tseparate (ms)\tmulti (ms)\tspeedup\tmulti / single pow_mod\n";
+
+    double single = 0;
+    for( std::size_t k : {1, 2, 3, 4, 8, 16, 64, 256, 1024} ) {
+        std::vector< std::pair< mpz_class, mpz_class > > terms;
+        for( std::size_t i = 0; i < k; i++ )
+            terms.push_back( {rng::gmp_generate( rng, bits - 1 ),
+                rng::gmp_generate( rng, exponent_bits )} );
+
+        mpz_class a, b;
+        double separate = bench::seconds_per_call( [&]() {
+            a = 1;
+            for( const auto & term : terms )
+                a = a * math::pow_mod( term.first, term.second, n ) % n;
+        });
+        double multi = bench::seconds_per_call( [&]() {
+            b = math::multi_pow_mod( terms, n );
+        });
+        if( a != b ) {
+            std::cout << "different results for k = " << k << '\n';
+            return 1;
+        }
+        if( k == 1 )
+            single = separate;
+        std::cout << k << '\t' << separate * 1000 << "\t\t" << multi * 1000 << "\t\t"
+            << separate / multi << '\t' << multi / single << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+/* Measures pinch::noticeboard::retrieve_data on a board with every
+ * group of 5 out of 45 users (1221759 groups),
+ * comparing the indexed lookup with the old linear scan.
+ *
+ * Usage: noticeboard_lookup [users] [threshold]
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "bench/bench.hpp"
+#include "math/set.hpp"
+#include "pinch/noticeboard.hpp"
+#include "random/xorshift.hpp"
+
+int main( int argc, char ** argv ) {
+    int users = 45, threshold = 5;
+    if( argc > 1 ) sscanf( argv[1], "%d", &users );
+    if( argc > 2 ) sscanf( argv[2], "%d", &threshold );
+
+    pinch::noticeboard<int> board;
+    math::combination c( users, threshold );
+    do {
+        pinch::group_data<int> data{ int(c.rank()), 0, {} };
+        for( int index : c.indexes() )
+            data.group.push_back( index + 1 );
+        board.groups.push_back( data );
+    } while( c.next() );
+
+    double build = bench::seconds_per_call( [&]() { board.build_index(); }, 0 );
+    std::cout << board.groups.size() << " groups; index built in " << build << " s\n";
+
+    rng::xorshift rng;
+    std::vector< std::vector<int> > queries;
+    for( int i = 0; i < 1000; i++ )
+        queries.push_back( board.groups[rng() % board.groups.size()].group );
+
+    int q = 0;
+    long sum = 0;
+    double indexed = bench::seconds_per_call( [&]() {
+        sum += board.retrieve_data( queries[q++ % queries.size()] ).group_generator;
+    });
+
+    auto unindexed = board;
+    unindexed.index.clear();
+    double linear = bench::seconds_per_call( [&]() {
+        sum += unindexed.retrieve_data( queries[q++ % queries.size()] ).group_generator;
+    });
+
+    std::cout << "indexed: " << 1 / indexed << " lookups/s\n"
+        << "linear:  " << 1 / linear << " lookups/s\n"
+        << "(checksum " << sum << ")\n";
+    return 0;
+}
@@ -0,0 +1,62 @@
+/* Measures the cost of generating one group of a Pinch noticeboard
+ * (dealer_information::fill_group) as the threshold grows,
+ * together with the exponentiation of the group generator
+ * by the product of the shares, with and without reducing
+ * the product modulo p-1 (see math/exponent_ring.hpp).
+ *
+ * Usage: pinch_board_generation [bits] [max threshold]
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "bench/bench.hpp"
+#include "math/exponent_ring.hpp"
+#include "math/generate_primes.hpp"
+#include "math/primitive_root.hpp"
+#include "pinch/dealer_information.hpp"
+#include "random/xorshift.hpp"
+
+int main( int argc, char ** argv ) {
+    int bits = 1024, max_threshold = 8;
+    if( argc > 1 ) sscanf( argv[1], "%d", &bits );
+    if( argc > 2 ) sscanf( argv[2], "%d", &max_threshold );
+
+    rng::xorshift rng;
+    auto prime = math::generate_factored_prime( rng, bits, 64, 25 );
+    pinch::dealer_information<mpz_class> dealer;
+    dealer.prime = prime.prime;
+    dealer.generator = math::primitive_root_modulo_p( prime.prime, prime.factors );
+    dealer.issue_shares( max_threshold, rng );
+
+    math::fixed_base<mpz_class> scratch;
+    const auto & f = dealer.generator_powers( scratch );
+    math::exponent_ring<mpz_class> exponents( dealer.prime - 1 );
+    mpz_class g_X = math::random_primitive_root_modulo_p( f, rng );
+
+    std::cout << "modulus bits: " << bits << '\n'
+        << "k\tgroups/s\tunreduced pow/s\treduced pow/s\n";
+    mpz_class sink;
+    for( int k = 2; k <= max_threshold; k++ ) {
+        std::vector<int> indexes;
+        mpz_class unreduced = 1;
+        for( int i = 0; i < k; i++ ) {
+            indexes.push_back( i );
+            unreduced *= dealer.valid_shares[i].share;
+        }
+        mpz_class reduced = exponents.reduce( unreduced );
+
+        pinch::group_data<mpz_class> data;
+        double group = bench::seconds_per_call( [&]() {
+            dealer.fill_group( data, indexes, mpz_class(42), f, rng );
+        });
+        double slow = bench::seconds_per_call( [&]() {
+            sink += math::pow_mod( g_X, unreduced, dealer.prime );
+        });
+        double fast = bench::seconds_per_call( [&]() {
+            sink += math::pow_mod( g_X, reduced, dealer.prime );
+        });
+        std::cout << k << '\t' << 1 / group << "\t\t" << 1 / slow << "\t\t" << 1 / fast << '\n';
+    }
+    return sink == 0;
+}
@@ -0,0 +1,66 @@
+/* Measures Pinch reconstructions per second,
+ * comparing the serial relay done by the command line tools
+ * (start_reconstruction, join by each user, reconstruct)
+ * with the pipelined pinch::reconstruction_coordinator.
+ *
+ * Every group of threshold out of users shares is reconstructed,
+ * with a modulus of the given number of bits.
+ *
+ * Usage: pinch_reconstruction [users] [threshold] [bits]
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "bench/bench.hpp"
+#include "math/generate_primes.hpp"
+#include "math/primitive_root.hpp"
+#include "pinch/dealer_information.hpp"
+#include "pinch/reconstruction.hpp"
+#include "random/xorshift.hpp"
+
+int main( int argc, char ** argv ) {
+    int users = 10, threshold = 4, bits = 1024;
+    if( argc > 1 ) sscanf( argv[1], "%d", &users );
+    if( argc > 2 ) sscanf( argv[2], "%d", &threshold );
+    if( argc > 3 ) sscanf( argv[3], "%d", &bits );
+
+    rng::xorshift rng;
+    auto prime = math::generate_factored_prime( rng, bits, 64, 25 );
+    pinch::dealer_information<mpz_class> dealer;
+    dealer.prime = prime.prime;
+    dealer.generator = math::primitive_root_modulo_p( prime.prime, prime.factors );
+    for( int i = 0; i < users; i++ )
+        dealer.new_share( rng );
+
+    mpz_class secret = 42;
+    auto board = dealer.generate_noticeboard( secret, threshold, rng );
+    std::vector< std::vector<int> > groups;
+    for( const auto & data : board.groups )
+        groups.push_back( data.group );
+    std::cout << groups.size() << " groups of " << threshold
+        << " out of " << users << " users, " << bits << "-bit modulus\n";
+
+    std::size_t next = 0, wrong = 0;
+    double serial = bench::seconds_per_call( [&]() {
+        const auto & group = groups[next++ % groups.size()];
+        const auto & starter = dealer.valid_shares[dealer.share_index( group[0] )];
+        auto pair = starter.start_reconstruction(
+                board, std::vector<int>( group.begin() + 1, group.end() ), rng );
+        for( std::size_t i = 1; i < group.size(); i++ )
+            dealer.valid_shares[dealer.share_index( group[i] )].join( pair.first );
+        wrong += pair.second.reconstruct( pair.first ) != secret;
+    });
+
+    pinch::reconstruction_coordinator<mpz_class> coordinator( dealer.valid_shares );
+    pinch::reconstruction_stats stats;
+    for( mpz_class s : coordinator.reconstruct( board, groups, rng, 0, &stats ) )
+        wrong += s != secret;
+
+    std::cout << "serial:    " << 1 / serial << " reconstructions/s\n"
+        << "pipelined: " << stats.per_second() << " reconstructions/s ("
+        << users << " stages)\n";
+    if( wrong != 0 )
+        std::cout << wrong << " reconstructions gave the wrong secret\n";
+    return wrong != 0;
+}
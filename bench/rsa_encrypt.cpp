@@ -0,0 +1,57 @@
+/* Compares RSA encryption with the default public exponent 65537
+ * against the random prime exponent with 2/3 of the key size
+ * that rsa --gen-key used to choose, and against decryption.
+ *
+ * Usage: rsa_encrypt [key size]
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <gmpxx.h>
+#include "bench/bench.hpp"
+#include "math/generate_primes.hpp"
+#include "protocols/rsa.hpp"
+#include "random/gmp_adapter.hpp"
+#include "random/xorshift.hpp"
+
+int main( int argc, char ** argv ) {
+    int key_size = 2048;
+    if( argc > 1 )
+        sscanf( argv[1], "%d", &key_size );
+
+    rng::xorshift rng;
+    mpz_class e = rsa::default_public_exponent;
+    auto primes = rsa::generate_key_primes( rng, key_size, e );
+    mpz_class p = primes.first, q = primes.second;
+    mpz_class big = math::generate_prime_number( rng, 2 * key_size / 3, 30 );
+    while( math::gcd( mpz_class((p-1) * (q-1)), big ) != 1 )
+        big = math::generate_prime_number( rng, 2 * key_size / 3, 30 );
+
+    auto small_key = rsa::build_public_key( p, q, e );
+    auto large_key = rsa::build_public_key( p, q, big );
+    auto private_key = rsa::build_private_key( p, q, e );
+
+    std::vector< mpz_class > messages( 64 );
+    for( auto & m : messages )
+        m = rng::gmp_generate( rng, key_size - 2 );
+
+    std::size_t i = 0;
+    mpz_class sink;
+    double small = bench::seconds_per_call( [&]() {
+        sink += small_key.encrypt( messages[i++ % messages.size()] );
+    });
+    double large = bench::seconds_per_call( [&]() {
+        sink += large_key.encrypt( messages[i++ % messages.size()] );
+    });
+    double decrypt = bench::seconds_per_call( [&]() {
+        sink += private_key.decrypt( messages[i++ % messages.size()] );
+    });
+
+    std::cout << "key size: " << key_size << '\n'
+        << "encrypt, e = 65537:          " << 1 / small << " ops/s\n"
+        << "encrypt, " << 2 * key_size / 3 << "-bit prime e: " << 1 / large << " ops/s\n"
+        << "decrypt:                     " << 1 / decrypt << " ops/s\n"
+        << "speedup: " << large / small << '\n';
+    return sink == 0;
+}
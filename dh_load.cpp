@@ -0,0 +1,126 @@
+namespace command_line {
+    const char help_message[] =
+" [options] <prime number> <primitive root>\n"
+"Load generator for dh_server.\n"
+"\n"
+"Keeps a number of sessions open at once; each session connects,\n"
+"does one key exchange and disconnects, and is replaced by a new one.\n"
+"At the end, writes the handshakes per second\n"
+"and the latency percentiles, in milliseconds.\n"
+"\n"
+"Options:\n"
+"--connect <endpoint>\n"
+"    Address of the server: unix:<path> or a port number on 127.0.0.1.\n"
+"    Default: unix:dh.sock\n"
+"\n"
+"--sessions <N>\n"
+"    Number of sessions open at once.\n"
+"    Default: 1000.\n"
+"\n"
+"--handshakes <N>\n"
+"    Total number of handshakes.\n"
+"    Default: 10000.\n"
+"\n"
+"--keys <N>\n"
+"    Number of distinct key pairs, precomputed, that the sessions use.\n"
+"    Default: 16.\n"
+"\n"
+"--order <q>\n"
+"    The primitive root is instead a generator of a subgroup of prime order q,\n"
+"    and private numbers are drawn below q (see generate_prime_number --subgroup).\n"
+"\n"
+"--stats\n"
+"    Writes the instrumentation counters to the standard error at exit\n"
+"    (see instrument/instrument.hpp; needs a build with -DINSTRUMENT).\n"
+"\n"
+"--help\n"
+"    Displays this help and quit.\n"
+;
+} // namespace command_line
+
+#include <cstdlib>
+#include <iostream>
+#include <gmpxx.h>
+#include "cmdline/args.hpp"
+#include "instrument/instrument.hpp"
+#include "net/socket.hpp"
+#include "protocols/dh_load.hpp"
+#include "random/xorshift.hpp"
+
+namespace command_line {
+    mpz_class prime, primitive_root;
+    std::string endpoint = "unix:dh.sock";
+    protocol::load_options options;
+
+    void parse( cmdline::args && args ) {
+        int positional = 0;
+        while( args.size() > 0 ) {
+            std::string arg = args.next();
+            if( arg == "--connect" ) {
+                endpoint = args.next();
+                continue;
+            }
+            if( arg == "--sessions" ) {
+                args.range( 1 ) >> options.sessions;
+                continue;
+            }
+            if( arg == "--handshakes" ) {
+                args.range( 1 ) >> options.handshakes;
+                continue;
+            }
+            if( arg == "--keys" ) {
+                args.range( 1 ) >> options.keys;
+                continue;
+            }
+            if( arg == "--order" ) {
+                args.range( 2 ) >> options.subgroup_order;
+                continue;
+            }
+            if( arg == "--stats" ) {
+                instrument::report_at_exit();
+                continue;
+            }
+            if( arg == "--help" ) {
+                std::cout << "Usage: " << args.program_name() << help_message;
+                std::exit( 0 );
+            }
+            mpz_class & target = positional == 0 ? prime : primitive_root;
+            if( positional == 2 || gmp_sscanf( arg.c_str(), "%Zd", target.get_mpz_t() ) != 1 ) {
+                std::cerr << args.program_name() << ": Unknown option " << arg << '\n';
+                std::exit( 1 );
+            }
+            positional++;
+        }
+        if( positional != 2 ) {
+            std::cerr << "The prime number and the primitive root must be given.\n";
+            std::exit( 1 );
+        }
+    }
+} // namespace command_line
+
+int main( int argc, char ** argv ) {
+    command_line::parse( cmdline::args( argc, argv ) );
+
+    net::endpoint endpoint;
+    try {
+        endpoint = net::parse_endpoint( command_line::endpoint );
+    } catch( std::invalid_argument & e ) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    std::size_t files = net::raise_file_limit();
+    if( command_line::options.sessions + 16 > files )
+        std::cerr << "Warning: only " << files << " files may be open at once.\n";
+
+    rng::xorshift rng;
+    auto stats = protocol::generate_load( endpoint, command_line::prime,
+        command_line::primitive_root, command_line::options, rng );
+
+    std::cout << "handshakes: " << stats.handshakes << '\n'
+        << "failures: " << stats.failures << '\n'
+        << "seconds: " << stats.seconds << '\n'
+        << "handshakes/s: " << stats.per_second() << '\n';
+    for( double p : {50.0, 90.0, 99.0, 99.9, 100.0} )
+        std::cout << "p" << p << " latency (ms): " << stats.percentile( p ) * 1000 << '\n';
+    return stats.failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+namespace command_line {
+    const char help_message[] =
+" [options] <prime number> <primitive root>\n"
+"Serves Diffie-Hellman key exchanges to many concurrent clients.\n"
+"\n"
+"Each client sends its public number as a line of hexadecimal digits,\n"
+"and receives the server's public number in the same format;\n"
+"every line starts a new exchange (see protocols/dh_service.hpp).\n"
+"The server runs until it receives SIGINT or SIGTERM,\n"
+"and then writes its counters to stderr.\n"
+"\n"
+"Options:\n"
+"--listen <endpoint>\n"
+"    Where to listen: unix:<path> for a Unix domain socket,\n"
+"    or a port number for TCP on 127.0.0.1.\n"
+"    Default: unix:dh.sock\n"
+"\n"
+"--threads <N>\n"
+"    Number of worker threads that compute the exchanges.\n"
+"    Default: number of processors.\n"
+"\n"
+"--pool <N>\n"
+"    Keep up to N key pairs precomputed by background threads,\n"
+"    so that each exchange needs a single exponentiation\n"
+"    (see protocols/dh_key_pool.hpp). Its counters are written at exit.\n"
+"    Default: 0 (no pool).\n"
+"\n"
+"--pool-threads <N>\n"
+"    Number of threads that refill the pool. They run at the lowest priority.\n"
+"    Default: 1.\n"
+"\n"
+"--order <q>\n"
+"    The primitive root is instead a generator of a subgroup of prime order q,\n"
+"    and private numbers are drawn below q (see generate_prime_number --subgroup).\n"
+"    Also, the clients' public numbers must lie in that subgroup.\n"
+"\n"
+"--stats\n"
+"    Writes the instrumentation counters to the standard error at exit\n"
+"    (see instrument/instrument.hpp; needs a build with -DINSTRUMENT).\n"
+"\n"
+"--help\n"
+"    Displays this help and quit.\n"
+;
+} // namespace command_line
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <gmpxx.h>
+#include "cmdline/args.hpp"
+#include "instrument/instrument.hpp"
+#include "net/socket.hpp"
+#include "parallel/parallel_for.hpp"
+#include "protocols/dh_key_pool.hpp"
+#include "protocols/dh_service.hpp"
+#include "random/xorshift.hpp"
+
+namespace command_line {
+    mpz_class prime, primitive_root;
+    std::string endpoint = "unix:dh.sock";
+    unsigned threads = parallel::default_threads();
+    mpz_class order = 0;
+    std::size_t pool = 0;
+    unsigned pool_threads = 1;
+
+    void parse( cmdline::args && args ) {
+        int positional = 0;
+        while( args.size() > 0 ) {
+            std::string arg = args.next();
+            if( arg == "--listen" ) {
+                endpoint = args.next();
+                continue;
+            }
+            if( arg == "--threads" ) {
+                args.range( 1 ) >> threads;
+                continue;
+            }
+            if( arg == "--pool" ) {
+                args.range( 0 ) >> pool;
+                continue;
+            }
+            if( arg == "--pool-threads" ) {
+                args.range( 0 ) >> pool_threads;
+                continue;
+            }
+            if( arg == "--order" ) {
+                args.range( 2 ) >> order;
+                continue;
+            }
+            if( arg == "--stats" ) {
+                instrument::report_at_exit();
+                continue;
+            }
+            if( arg == "--help" ) {
+                std::cout << "Usage: " << args.program_name() << help_message;
+                std::exit( 0 );
+            }
+            mpz_class & target = positional == 0 ? prime : primitive_root;
+            if( positional == 2 || gmp_sscanf( arg.c_str(), "%Zd", target.get_mpz_t() ) != 1 ) {
+                std::cerr << args.program_name() << ": Unknown option " << arg << '\n';
+                std::exit( 1 );
+            }
+            positional++;
+        }
+        if( positional != 2 ) {
+            std::cerr << "The prime number and the primitive root must be given.\n";
+            std::exit( 1 );
+        }
+    }
+} // namespace command_line
+
+protocol::dh_server * running_server = nullptr;
+
+extern "C" void stop_server( int ) {
+    if( running_server )
+        running_server->stop();
+}
+
+int main( int argc, char ** argv ) {
+    command_line::parse( cmdline::args( argc, argv ) );
+
+    net::endpoint endpoint;
+    try {
+        endpoint = net::parse_endpoint( command_line::endpoint );
+    } catch( std::invalid_argument & e ) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    std::size_t files = net::raise_file_limit();
+    protocol::dh_server server( command_line::prime, command_line::primitive_root,
+        command_line::threads, command_line::order );
+    try {
+        server.listen( endpoint );
+    } catch( std::system_error & e ) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    running_server = &server;
+    std::signal( SIGINT, stop_server );
+    std::signal( SIGTERM, stop_server );
+    std::cerr << "Listening on " << net::to_string( endpoint ) << " with "
+        << command_line::threads << " workers (up to " << files << " open files)\n";
+
+    rng::xorshift rng;
+    std::unique_ptr< protocol::dh_key_pool > pool;
+    if( command_line::pool > 0 ) {
+        pool.reset( new protocol::dh_key_pool( command_line::prime,
+            command_line::primitive_root, command_line::order,
+            command_line::pool, command_line::pool_threads, rng ) );
+        server.use_key_pool( pool.get() );
+    }
+    server.run( rng );
+    running_server = nullptr;
+
+    auto stats = server.stats();
+    std::cerr << "connections: " << stats.connections << '\n'
+        << "exchanges: " << stats.exchanges << '\n'
+        << "rejected: " << stats.rejected << '\n'
+        << "peak connections: " << stats.peak_connections << '\n';
+    if( pool ) {
+        auto pool_stats = pool->stats();
+        std::cerr << "pool capacity: " << pool_stats.capacity << '\n'
+            << "pool hits: " << pool_stats.hits << '\n'
+            << "pool misses: " << pool_stats.misses << '\n'
+            << "pool hit rate: " << pool_stats.hit_rate() << '\n'
+            << "pool refill rate (pairs/s): " << pool_stats.refill_rate() << '\n'
+            << "pool occupancy: " << pool_stats.occupancy() << '\n'
+            << "pool lowest occupancy: " << pool_stats.lowest_ready << '\n';
+    }
+    return 0;
+}
@@ -4,20 +4,61 @@
 #include <cstdio>
 #include <gmpxx.h>
 #include <iostream>
+#include <string>
+#include "instrument/instrument.hpp"
 #include "protocols/diffie_hellman.hpp"
+#include "protocols/x25519.hpp"
 #include "random/xorshift.hpp"
 
+/* Same exchange over Curve25519 (protocols/x25519.hpp);
+ * the keys are written and read as 64 hexadecimal digits.
+ */
+int x25519_exchange() {
+    protocol::x25519 dh;
+    rng::xorshift rng;
+
+    dh.generate_private_number( rng );
+    std::cout << "Our public number: " << protocol::to_hex( dh.get_public_number() ) << '\n';
+    std::cout << "Input parter's public number: ";
+
+    std::string input;
+    protocol::x25519_key partner_public;
+    std::cin >> input;
+    if( !protocol::from_hex( input, partner_public ) ||
+        !dh.set_partner_public_number( partner_public ) ) {
+        std::cout << "Invalid public number.\n";
+        return 1;
+    }
+
+    std::cout << "Common secret is " << protocol::to_hex( dh.get_common_secret() ) << '\n';
+    return 0;
+}
+
 int main( int argc, char ** argv ) {
-    if( argc != 3 ) {
-        std::cout << "Usage: " << argv[0] << " <prime number> <primitive root>\n";
+    instrument::take_stats_option( argc, argv );
+    if( argc == 2 && std::string( argv[1] ) == "--x25519" )
+        return x25519_exchange();
+
+    if( argc != 3 && argc != 4 ) {
+        std::cout << "Usage: " << argv[0] << " <prime number> <primitive root> [subgroup order]\n"
+            << "       " << argv[0] << " --x25519\n"
+            << "With a subgroup order q, the primitive root is instead\n"
+            << "a generator of the subgroup of order q (see generate_prime_number --subgroup),\n"
+            << "and the partner's public number is checked to lie in that subgroup.\n"
+            << "With --x25519, the exchange is done over Curve25519 instead\n"
+            << "(RFC 7748), with keys written in hexadecimal.\n"
+            << "With --stats, anywhere, the instrumentation counters are written\n"
+            << "to the standard error at exit (needs a build with -DINSTRUMENT).\n";
         return 1;
     }
 
-    mpz_class number, primitive_root;
+    mpz_class number, primitive_root, order = 0;
     gmp_sscanf( argv[1], "%Zd", number.get_mpz_t() );
     gmp_sscanf( argv[2], "%Zd", primitive_root.get_mpz_t() );
+    if( argc == 4 )
+        gmp_sscanf( argv[3], "%Zd", order.get_mpz_t() );
 
-    protocol::diffie_hellman<> dh( number, primitive_root );
+    protocol::diffie_hellman<> dh( number, primitive_root, order );
     rng::xorshift rng;
 
     dh.generate_private_number( rng );
@@ -26,7 +67,10 @@ int main( int argc, char ** argv ) {
 
     mpz_class partner_public;
     std::cin >> partner_public;
-    dh.set_partner_public_number( partner_public );
+    if( !dh.set_partner_public_number( partner_public, order != 0 ) ) {
+        std::cout << "Invalid public number.\n";
+        return 1;
+    }
 
     std::cout << "Common secret is " << dh.get_common_secret() << '\n';
 
@@ -4,12 +4,14 @@
 
 #include <iostream>
 #include <gmpxx.h>
+#include "instrument/instrument.hpp"
 #include "math/factor.hpp"
 
 int main( int argc, char ** argv ) {
+    instrument::take_stats_option( argc, argv );
     mpz_class number;
     if( argc != 2 || gmp_sscanf( argv[1], "%Zd", number.get_mpz_t() ) != 1 ) {
-        std::cerr << "Usage: " << argv[0] << " [number to be factored]\n";
+        std::cerr << "Usage: " << argv[0] << " [--stats] [number to be factored]\n";
         return 1;
     }
 
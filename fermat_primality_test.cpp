@@ -1,12 +1,14 @@
 /* Interface to the fermat primalty test.
  */
 #include <iostream>
+#include "instrument/instrument.hpp"
 #include "random/xorshift.hpp"
 #include "math/primality.hpp"
 
 int main( int argc, char ** argv ) {
+    instrument::take_stats_option( argc, argv );
     if( argc != 3 ) {
-        std::cerr << "Usage: " << argv[0] << " [number] [trials]\n";
+        std::cerr << "Usage: " << argv[0] << " [--stats] [number] [trials]\n";
         return 1;
     }
 
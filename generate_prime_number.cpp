@@ -15,6 +15,25 @@ namespace command_line {
 "    Chose the number of trials to Fermat's primality test.\n"
 "    Default: 30.\n"
 "\n"
+"--safe\n"
+"    Generate a safe prime p; that is, (p-1)/2 is also prime.\n"
+"\n"
+"--factored <N>\n"
+"    Generate a prime p such that p-1 is 2 times primes of about N bits.\n"
+"\n"
+"--subgroup <N>\n"
+"    Generate a prime p such that p-1 has a prime factor q with N bits,\n"
+"    for Diffie-Hellman with short private numbers.\n"
+"    Print p, q and a generator of the subgroup of order q, one per line.\n"
+"\n"
+"--generator\n"
+"    Also print, in the next line, the smallest primitive root modulo p.\n"
+"    Needs --safe or --factored, because p-1 must have known factors.\n"
+"\n"
+"--stats\n"
+"    Writes the instrumentation counters to the standard error at exit\n"
+"    (see instrument/instrument.hpp; needs a build with -DINSTRUMENT).\n"
+"\n"
 "--help\n"
 "    Displays this help and quit.\n"
 ;
@@ -22,13 +41,20 @@ namespace command_line {
 
 #include <iostream>
 #include "cmdline/args.hpp"
+#include "instrument/instrument.hpp"
 #include "random/xorshift.hpp"
+#include "math/generate_primes.hpp"
 #include "math/primality.hpp"
+#include "math/primitive_root.hpp"
 
 namespace command_line {
     bool verbose = false;
     int fermat_trials = 30;
     int bits;
+    bool safe = false;
+    int factor_bits = 0;
+    int subgroup_bits = 0;
+    bool generator = false;
 
     void parse( cmdline::args && args ) {
         while( args.size() > 0 ) {
@@ -43,12 +69,45 @@ namespace command_line {
                 args >> fermat_trials;
                 continue;
             }
+            if( arg == "--safe" ) {
+                args.shift();
+                safe = true;
+                continue;
+            }
+            if( arg == "--factored" ) {
+                args.shift();
+                args >> factor_bits;
+                continue;
+            }
+            if( arg == "--subgroup" ) {
+                args.shift();
+                args >> subgroup_bits;
+                continue;
+            }
+            if( arg == "--generator" ) {
+                args.shift();
+                generator = true;
+                continue;
+            }
+            if( arg == "--stats" ) {
+                args.shift();
+                instrument::report_at_exit();
+                continue;
+            }
             if( arg == "--help" ) {
                 std::cout << "Usage: " << args.program_name() << help_message;
                 std::exit( 0 );
             }
             args >> bits;
         }
+        if( generator && !safe && factor_bits == 0 ) {
+            std::cerr << "--generator needs either --safe or --factored.\n";
+            std::exit( 1 );
+        }
+        if( subgroup_bits != 0 && subgroup_bits + 2 > bits ) {
+            std::cerr << "The subgroup order must have at least two bits less than p.\n";
+            std::exit( 1 );
+        }
     }
 }
 
@@ -57,6 +116,43 @@ int main( int argc, char ** argv ) {
     command_line::parse( cmdline::args(argc, argv) );
 
     rng::xorshift rng;
+
+    if( command_line::subgroup_bits != 0 ) {
+        auto p = math::generate_subgroup_prime( rng, command_line::bits,
+            command_line::subgroup_bits, command_line::fermat_trials );
+        if( command_line::verbose )
+            std::cout << "Prime: " << p.prime << "\nSubgroup order: " << p.order
+                << "\nGenerator: " << p.generator << '\n';
+        else
+            std::cout << p.prime << '\n' << p.order << '\n' << p.generator << '\n';
+        return 0;
+    }
+
+    if( command_line::safe || command_line::factor_bits != 0 ) {
+        math::factored_prime<mpz_class> p = command_line::safe ?
+            math::generate_safe_prime( rng, command_line::bits,
+                command_line::fermat_trials ) :
+            math::generate_factored_prime( rng, command_line::bits,
+                command_line::factor_bits, command_line::fermat_trials );
+
+        if( command_line::verbose ) {
+            std::cout << "Found prime number " << p.prime << "\np-1:";
+            for( const auto & pair : p.factors )
+                for( int i = 0; i < pair.second; i++ )
+                    std::cout << ' ' << pair.first;
+            std::cout << '\n';
+        }
+        else
+            std::cout << p.prime << '\n';
+
+        if( command_line::generator ) {
+            if( command_line::verbose )
+                std::cout << "Primitive root: ";
+            std::cout << math::primitive_root_modulo_p( p.prime, p.factors ) << '\n';
+        }
+        return 0;
+    }
+
     int attempts = 0;
     mpz_class number;
 
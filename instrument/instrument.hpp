@@ -0,0 +1,282 @@
+#ifndef INSTRUMENT_INSTRUMENT_HPP
+#define INSTRUMENT_INSTRUMENT_HPP
+
+/* Hot-path instrumentation: event counters and scoped timers.
+ *
+ * The instrumentation is compiled in only if the macro INSTRUMENT is defined,
+ * as in
+ *      make CXXFLAGS="-g -O2 -DINSTRUMENT"
+ * Otherwise count() is empty and scoped_timer is an empty object,
+ * so the instrumented code compiles to the same as without them,
+ * and the reports say that the counters are disabled.
+ *
+ * Each thread counts in a block of its own, without atomic
+ * read-modify-write operations and without sharing cache lines.
+ * totals() adds up the blocks of the running threads
+ * and the counts left by the threads that already finished.
+ *
+ * Every program accepts --stats, which prints the totals
+ * to the standard error when the program exits (see report_at_exit).
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef INSTRUMENT
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace instrument {
+
+#ifdef INSTRUMENT
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+    enum class counter {
+        pow_mod,                // Calls to the pow_mod family and fixed_base::pow
+        multiplications,        // Modular multiplications, including squarings
+        gcd,
+        fermat_trials,
+        trial_divisions,        // Small primes tried by trial division
+        rho_iterations,         // Iterations of Pollard's rho
+        rng_words,              // Words drawn from xorshift generators
+        random_numbers,         // Numbers made by rng::gmp_generate
+        key_exchanges,          // Common secrets computed by Diffie-Hellman
+        rsa_operations,         // RSA encryptions and decryptions
+        noticeboard_groups,     // Pinch groups generated
+        reconstructions,        // Pinch reconstructions started
+        count_                  // Number of counters; not a counter
+    };
+
+    enum class timer {
+        factor,                 // math::factor::factor
+        fermat,                 // math::primality::fermat
+        generate_noticeboard,
+        reconstruct,            // pinch::private_nonce::reconstruct
+        dh_exchange,            // Server side of a Diffie-Hellman exchange
+        count_                  // Number of timers; not a timer
+    };
+
+    constexpr std::size_t counters = std::size_t( counter::count_ );
+    constexpr std::size_t timers = std::size_t( timer::count_ );
+
+    const char * name( counter );
+    const char * name( timer );
+
+    // Adds n to the counter, in the calling thread's block.
+    void count( counter, std::uint64_t n = 1 );
+
+    /* Adds the time between its construction and its destruction
+     * to the timer, and counts one call.
+     */
+    class scoped_timer {
+    public:
+        scoped_timer( const scoped_timer & ) = delete;
+        scoped_timer & operator=( const scoped_timer & ) = delete;
+#ifdef INSTRUMENT
+        explicit scoped_timer( timer t );
+        ~scoped_timer();
+    private:
+        timer t;
+        std::chrono::steady_clock::time_point start;
+#else
+        explicit scoped_timer( timer ) {}
+#endif
+    };
+
+    struct snapshot {
+        std::uint64_t counts[counters] = {};
+        std::uint64_t calls[timers] = {};
+        std::uint64_t nanoseconds[timers] = {};
+
+        std::uint64_t operator[]( counter c ) const { return counts[std::size_t(c)]; }
+    };
+
+    // Sum of the counters of every thread so far; all zero if disabled.
+    snapshot totals();
+
+    /* Writes one line per counter and per timer,
+     * or a note saying that instrumentation is disabled.
+     */
+    void report( std::ostream &, const snapshot & );
+
+    /* Makes the program write report( std::cerr, totals() ) when it exits
+     * through exit() or by returning from main.
+     * Calling it more than once has no further effect.
+     */
+    void report_at_exit();
+
+    /* Removes every "--stats" from the arguments, for programs
+     * that read argv directly, and calls report_at_exit if there was one.
+     */
+    void take_stats_option( int & argc, char ** argv );
+
+// Implementation
+
+    inline const char * name( counter c ) {
+        static const char * const names[counters] = {
+            "pow_mod", "multiplications", "gcd", "fermat_trials",
+            "trial_divisions", "rho_iterations", "rng_words", "random_numbers",
+            "key_exchanges", "rsa_operations", "noticeboard_groups",
+            "reconstructions",
+        };
+        return names[std::size_t(c)];
+    }
+
+    inline const char * name( timer t ) {
+        static const char * const names[timers] = {
+            "factor", "fermat", "generate_noticeboard", "reconstruct", "dh_exchange",
+        };
+        return names[std::size_t(t)];
+    }
+
+#ifdef INSTRUMENT
+namespace detail {
+
+    /* Counters of one thread. Only the owner thread writes to them,
+     * so a relaxed load and store suffice; the atomics only make
+     * the reads of totals() well defined.
+     */
+    struct alignas(64) block {
+        std::atomic< std::uint64_t > counts[counters];
+        std::atomic< std::uint64_t > calls[timers];
+        std::atomic< std::uint64_t > nanoseconds[timers];
+
+        block();
+        ~block();
+    };
+
+    struct registry {
+        std::mutex mutex;
+        std::vector< block * > live;
+        snapshot finished; // Counts of the threads that already exited
+    };
+
+    inline registry & global() {
+        static registry r;
+        return r;
+    }
+
+    inline block & local() {
+        thread_local block b;
+        return b;
+    }
+
+    inline void add( std::atomic< std::uint64_t > & v, std::uint64_t n ) {
+        v.store( v.load( std::memory_order_relaxed ) + n, std::memory_order_relaxed );
+    }
+
+    inline void add_to( snapshot & s, const block & b ) {
+        for( std::size_t i = 0; i < counters; i++ )
+            s.counts[i] += b.counts[i].load( std::memory_order_relaxed );
+        for( std::size_t i = 0; i < timers; i++ ) {
+            s.calls[i] += b.calls[i].load( std::memory_order_relaxed );
+            s.nanoseconds[i] += b.nanoseconds[i].load( std::memory_order_relaxed );
+        }
+    }
+
+    inline block::block() {
+        for( auto & c : counts ) c.store( 0, std::memory_order_relaxed );
+        for( auto & c : calls ) c.store( 0, std::memory_order_relaxed );
+        for( auto & c : nanoseconds ) c.store( 0, std::memory_order_relaxed );
+        registry & r = global();
+        std::lock_guard< std::mutex > lock( r.mutex );
+        r.live.push_back( this );
+    }
+
+    inline block::~block() {
+        registry & r = global();
+        std::lock_guard< std::mutex > lock( r.mutex );
+        add_to( r.finished, *this );
+        r.live.erase( std::find( r.live.begin(), r.live.end(), this ) );
+    }
+
+} // namespace detail
+#endif // INSTRUMENT
+
+    inline void count( counter c, std::uint64_t n ) {
+#ifdef INSTRUMENT
+        detail::add( detail::local().counts[std::size_t(c)], n );
+#else
+        (void) c; (void) n;
+#endif
+    }
+
+#ifdef INSTRUMENT
+    inline scoped_timer::scoped_timer( timer t ) :
+        t( t ),
+        start( std::chrono::steady_clock::now() )
+    {}
+
+    inline scoped_timer::~scoped_timer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        detail::block & b = detail::local();
+        detail::add( b.calls[std::size_t(t)], 1 );
+        detail::add( b.nanoseconds[std::size_t(t)],
+            std::chrono::duration_cast< std::chrono::nanoseconds >( elapsed ).count() );
+    }
+#endif
+
+    inline snapshot totals() {
+        snapshot s;
+#ifdef INSTRUMENT
+        detail::registry & r = detail::global();
+        std::lock_guard< std::mutex > lock( r.mutex );
+        s = r.finished;
+        for( const detail::block * b : r.live )
+            detail::add_to( s, *b );
+#endif
+        return s;
+    }
+
+    inline void report( std::ostream & os, const snapshot & s ) {
+        if( !enabled ) {
+            os << "Instrumentation disabled; rebuild with -DINSTRUMENT to count.\n";
+            return;
+        }
+        for( std::size_t i = 0; i < counters; i++ )
+            os << name( counter(i) ) << ": " << s.counts[i] << '\n';
+        for( std::size_t i = 0; i < timers; i++ )
+            os << name( timer(i) ) << ": " << s.calls[i] << " calls, "
+                << s.nanoseconds[i] / 1e9 << " s\n";
+    }
+
+    inline void report_at_exit() {
+#ifdef INSTRUMENT
+        /* Constructing the registry now makes it outlive the handler,
+         * because objects with static storage are destroyed
+         * in the reverse order of the registration of the atexit handlers.
+         */
+        detail::global();
+#endif
+        static bool registered = false;
+        if( registered )
+            return;
+        registered = true;
+        std::atexit( []() {
+            report( std::cerr, totals() );
+        });
+    }
+
+    inline void take_stats_option( int & argc, char ** argv ) {
+        int kept = 1;
+        for( int i = 1; i < argc; i++ )
+            if( std::strcmp( argv[i], "--stats" ) == 0 )
+                report_at_exit();
+            else
+                argv[kept++] = argv[i];
+        argc = kept;
+        argv[argc] = nullptr;
+    }
+
+} // namespace instrument
+
+#endif // INSTRUMENT_INSTRUMENT_HPP
@@ -1,6 +1,15 @@
 #ifndef MATH_ALGO_HPP
 #define MATH_ALGO_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <gmpxx.h>
+#include "instrument/instrument.hpp"
+
 namespace math {
     /* Computes t^i mod n.
      * We assume T(1) is the multiplicative identity of T
@@ -9,22 +18,236 @@ namespace math {
      */
     template< typename T, typename U >
     T pow_mod( T t, U i, T n ) {
+        instrument::count( instrument::counter::pow_mod );
         t = t % n;
         T r(1);
         while( i != 0 ) {
-            if( i % 2 == 1 )
+            if( i % 2 == 1 ) {
                 r = r * t % n;
+                instrument::count( instrument::counter::multiplications );
+            }
             t = t * t % n;
+            instrument::count( instrument::counter::multiplications );
             i >>= 1;
         }
         return r;
     }
 
+    /* Computes t^e mod n, for an exponent that fits in a machine word,
+     * scanning e from its most significant bit.
+     * This follows the binary addition chain of e:
+     * one squaring per bit and one multiplication per set bit after the first;
+     * for e = 65537 = 2^16 + 1, 16 squarings and a single multiplication.
+     * Unlike pow_mod, the exponent is never a T.
+     */
+    template< typename T >
+    T pow_mod_word( T t, unsigned long e, T n ) {
+        instrument::count( instrument::counter::pow_mod );
+        if( e == 0 )
+            return T(1) % n;
+        t = t % n;
+        T r = t;
+        for( int bit = 8 * sizeof(e) - 2 - __builtin_clzl( e ); bit >= 0; bit-- ) {
+            r = r * r % n;
+            if( (e >> bit) & 1 )
+                r = r * t % n;
+        }
+        instrument::count( instrument::counter::multiplications,
+            8 * sizeof(e) - 2 - __builtin_clzl( e ) + __builtin_popcountl( e ) );
+        return r;
+    }
+
+    /* If e is non-negative and fits in an unsigned long,
+     * stores it in word and returns true; otherwise, returns false.
+     */
+    inline bool to_word( const mpz_class & e, unsigned long & word ) {
+        if( !mpz_fits_ulong_p( e.get_mpz_t() ) )
+            return false;
+        word = e.get_ui();
+        return true;
+    }
+
+    template< typename T >
+    bool to_word( T e, unsigned long & word ) {
+        if( e < 0 )
+            return false;
+        word = e;
+        return true;
+    }
+
+    /* Number of bits needed to represent n, which must be non-negative.
+     */
+    inline std::uint32_t bit_length( const mpz_class & n ) {
+        return n == 0 ? 0 : mpz_sizeinbase( n.get_mpz_t(), 2 );
+    }
+
+    template< typename T >
+    typename std::enable_if< std::is_integral<T>::value, std::uint32_t >::type
+    bit_length( T n ) {
+        std::uint32_t bits = 0;
+        for( std::uint64_t v = n; v != 0; v >>= 1 )
+            bits++;
+        return bits;
+    }
+
+    /* The w bits of n that start at the given bit position.
+     */
+    inline unsigned window_digit( const mpz_class & n, std::uint32_t position, unsigned w ) {
+        unsigned digit = 0;
+        for( unsigned j = w; j > 0; j-- )
+            digit = digit << 1 | mpz_tstbit( n.get_mpz_t(), position + j - 1 );
+        return digit;
+    }
+
+    template< typename T >
+    typename std::enable_if< std::is_integral<T>::value, unsigned >::type
+    window_digit( T n, std::uint32_t position, unsigned w ) {
+        if( position >= 64 )
+            return 0;
+        return (std::uint64_t(n) >> position) & ((1u << w) - 1);
+    }
+
+    /* Computes the product of every base^exponent mod n,
+     * for the given (base, exponent) pairs; the exponents must be non-negative.
+     *
+     * Instead of one exponentiation per pair, every pair shares
+     * a single chain of squarings, with the exponents scanned in windows
+     * of w bits from the most significant one. Between two windows,
+     * the accumulator is squared w times and multiplied by
+     *  - Straus: the power base_i^digit_i of each pair,
+     *    taken from a table of the 2^w - 1 powers of each base;
+     *  - Pippenger: the product over every digit d of B_d^d,
+     *    where the bucket B_d is the product of the bases whose digit is d.
+     *    The buckets are combined with 2 * 2^w multiplications
+     *    through running products, whatever the number of pairs.
+     * Straus costs about k * (2^w + bits/w) multiplications,
+     * and Pippenger about (bits/w) * (k + 2^(w+1));
+     * the cheaper one, with the best window, is chosen.
+     * For k = 2, this is close to the cost of a single exponentiation,
+     * and for large k the cost per pair decreases as k grows.
+     */
+    template< typename T >
+    T multi_pow_mod( const std::vector< std::pair<T, T> > & terms, const T & n ) {
+        instrument::count( instrument::counter::pow_mod );
+        const std::size_t k = terms.size();
+        std::uint32_t bits = 0;
+        for( const auto & term : terms )
+            bits = std::max( bits, bit_length( term.second ) );
+        if( bits == 0 )
+            return T(1) % n;
+
+        // Estimated number of multiplications for each method and window.
+        bool pippenger = false;
+        unsigned w = 1;
+        double best = 0;
+        for( unsigned c = 1; c <= 16; c++ ) {
+            double windows = (bits + c - 1) / c;
+            double straus = k * ((1u << c) - 2 + windows);
+            double buckets = windows * (k + (2u << c));
+            if( c == 1 || straus < best ) {
+                best = straus;
+                w = c;
+                pippenger = false;
+            }
+            if( buckets < best ) {
+                best = buckets;
+                w = c;
+                pippenger = true;
+            }
+        }
+
+        const std::uint32_t windows = (bits + w - 1) / w;
+        const unsigned digits = (1u << w) - 1;
+        T result(1);
+        bool started = false; // While false, result is 1 and is not squared
+
+        // Multiplies result by x.
+        auto accumulate = [&]( const T & x ) {
+            if( started )
+                instrument::count( instrument::counter::multiplications );
+            result = started ? T(result * x % n) : x;
+            started = true;
+        };
+
+        // Squares result w times, unless it is still 1.
+        auto shift = [&]() {
+            if( !started )
+                return;
+            for( unsigned s = 0; s < w; s++ )
+                result = result * result % n;
+            instrument::count( instrument::counter::multiplications, w );
+        };
+
+        if( !pippenger ) {
+            std::vector< T > table( k * digits ); // base_i^d is at table[i * digits + d - 1]
+            for( std::size_t i = 0; i < k; i++ ) {
+                table[i * digits] = terms[i].first % n;
+                for( unsigned d = 1; d < digits; d++ )
+                    table[i * digits + d] = table[i * digits + d - 1] * table[i * digits] % n;
+            }
+            instrument::count( instrument::counter::multiplications, k * (digits - 1) );
+            for( std::uint32_t window = windows; window-- > 0; ) {
+                shift();
+                for( std::size_t i = 0; i < k; i++ ) {
+                    unsigned d = window_digit( terms[i].second, window * w, w );
+                    if( d != 0 )
+                        accumulate( table[i * digits + d - 1] );
+                }
+            }
+            return result % n;
+        }
+
+        std::vector< T > buckets( digits + 1 );
+        std::vector< bool > used( digits + 1 );
+        for( std::uint32_t window = windows; window-- > 0; ) {
+            shift();
+
+            std::fill( used.begin(), used.end(), false );
+            for( std::size_t i = 0; i < k; i++ ) {
+                unsigned d = window_digit( terms[i].second, window * w, w );
+                if( d == 0 )
+                    continue;
+                if( used[d] )
+                    instrument::count( instrument::counter::multiplications );
+                buckets[d] = used[d] ? T(buckets[d] * terms[i].first % n) : T(terms[i].first % n);
+                used[d] = true;
+            }
+
+            /* The product of B_d^d is the product, for d from the top,
+             * of the running products B_top * ... * B_d.
+             */
+            T running, sum;
+            bool have_running = false, have_sum = false;
+            for( unsigned d = digits; d > 0; d-- ) {
+                if( used[d] ) {
+                    if( have_running )
+                        instrument::count( instrument::counter::multiplications );
+                    running = have_running ? T(running * buckets[d] % n) : buckets[d];
+                    have_running = true;
+                }
+                if( have_running ) {
+                    if( have_sum )
+                        instrument::count( instrument::counter::multiplications );
+                    sum = have_sum ? T(sum * running % n) : running;
+                    have_sum = true;
+                }
+            }
+            if( have_sum )
+                accumulate( sum );
+        }
+        return result % n;
+    }
+
     /* Returns the greatest common divisor of a and b,
      * using an iterative version of the euclidean algorithm.
+     *
+     * There are specializations below for machine integers,
+     * that use Stein's binary algorithm,
+     * and for mpz_class, that delegates to GMP.
      */
     template< typename T >
     T gcd( T a, T b ) {
+        instrument::count( instrument::counter::gcd );
         T tmp;
         while( b != 0 ) {
             tmp = a % b;
@@ -34,6 +257,79 @@ namespace math {
         return a;
     }
 
+    /* Stein's binary GCD algorithm.
+     * Replaces the divisions of the euclidean algorithm
+     * by shifts and subtractions, which are much cheaper on machine words.
+     */
+    inline unsigned long long binary_gcd( unsigned long long a, unsigned long long b ) {
+        instrument::count( instrument::counter::gcd );
+        if( a == 0 ) return b;
+        if( b == 0 ) return a;
+
+        // Common powers of two are factored out and restored at the end.
+        int shift = __builtin_ctzll( a | b );
+        a >>= __builtin_ctzll( a );
+        do {
+            // Here, a is always odd, and so is the gcd of a and b.
+            b >>= __builtin_ctzll( b );
+            if( a > b )
+                std::swap( a, b );
+            b -= a;
+        } while( b != 0 );
+        return a << shift;
+    }
+
+    /* Absolute value of a machine integer,
+     * as an unsigned value (so that the most negative number is representable).
+     */
+    template< typename T >
+    unsigned long long unsigned_abs( T a ) {
+        return a < 0 ? 0ull - (unsigned long long) a : (unsigned long long) a;
+    }
+
+    template<>
+    inline int gcd<int>( int a, int b ) {
+        return binary_gcd( unsigned_abs(a), unsigned_abs(b) );
+    }
+
+    template<>
+    inline long gcd<long>( long a, long b ) {
+        return binary_gcd( unsigned_abs(a), unsigned_abs(b) );
+    }
+
+    template<>
+    inline long long gcd<long long>( long long a, long long b ) {
+        return binary_gcd( unsigned_abs(a), unsigned_abs(b) );
+    }
+
+    template<>
+    inline unsigned gcd<unsigned>( unsigned a, unsigned b ) {
+        return binary_gcd( a, b );
+    }
+
+    template<>
+    inline unsigned long gcd<unsigned long>( unsigned long a, unsigned long b ) {
+        return binary_gcd( a, b );
+    }
+
+    template<>
+    inline unsigned long long gcd<unsigned long long>(
+        unsigned long long a,
+        unsigned long long b
+    ) {
+        return binary_gcd( a, b );
+    }
+
+    /* GMP chooses between the euclidean, Lehmer's and the subquadratic
+     * half-gcd algorithm based on the size of the operands.
+     */
+    template<>
+    inline mpz_class gcd<mpz_class>( mpz_class a, mpz_class b ) {
+        instrument::count( instrument::counter::gcd );
+        mpz_gcd( a.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t() );
+        return a;
+    }
+
     /* Data for the Extended Euclid's algorithm.
      */
     template< typename T >
@@ -43,25 +339,38 @@ namespace math {
         T gcd; // The greatest common divisor
     };
 
+    /* Returns x, y and gcd(a, b) such that a*x + b*y == gcd(a, b).
+     *
+     * The coefficients are updated in place,
+     * computing each quotient only once per iteration.
+     */
     template< typename T >
     euclid_data<T> extended_euclid( T a, T b ) {
-        T xx = T(1), xy = T(0), yx = T(0), yy = T(1);
+        T xx(1), xy(0), yx(0), yy(1);
+        T q;
         while( b != 0 ) {
-            T nxy = xx - xy*(a/b);
-            xx = xy;
-            xy = nxy;
+            q = a / b;
 
-            T nyy = yx - yy*(a/b);
-            yx = yy;
-            yy = nyy;
+            a -= q * b;
+            std::swap( a, b );
 
-            T nb = a % b;
-            a = b;
-            b = nb;
+            xx -= q * xy;
+            std::swap( xx, xy );
+
+            yx -= q * yy;
+            std::swap( yx, yy );
         }
         return {xx, yx, a};
     }
 
+    template<>
+    inline euclid_data<mpz_class> extended_euclid<mpz_class>( mpz_class a, mpz_class b ) {
+        euclid_data<mpz_class> d;
+        mpz_gcdext( d.gcd.get_mpz_t(), d.x.get_mpz_t(), d.y.get_mpz_t(),
+                    a.get_mpz_t(), b.get_mpz_t() );
+        return d;
+    }
+
     /* Computes the inverse of a modulo n.
      * This algorithm assumes gcd(a, n) == 1.
      */
@@ -71,6 +380,74 @@ namespace math {
         return (d.x + n) % n;
     }
 
+    template<>
+    inline mpz_class modular_inverse<mpz_class>( mpz_class a, mpz_class n ) {
+        mpz_invert( a.get_mpz_t(), a.get_mpz_t(), n.get_mpz_t() );
+        return a;
+    }
+
+    /* Replaces each of the 'count' values starting at 'values'
+     * by its inverse modulo n, using Montgomery's trick:
+     * a single modular inversion and 3(count-1) modular multiplications.
+     *
+     * Values that are not invertible modulo n are left untouched,
+     * and their indexes are returned, in increasing order;
+     * the remaining values are inverted normally.
+     */
+    template< typename T >
+    std::vector< std::size_t > batch_modular_inverse( T * values, std::size_t count, T n );
+
+    template< typename T >
+    std::vector< std::size_t > batch_modular_inverse( std::vector<T> & values, T n ) {
+        return batch_modular_inverse( values.data(), values.size(), n );
+    }
+
+    template< typename T >
+    std::vector< std::size_t > batch_modular_inverse( T * values, std::size_t count, T n ) {
+        std::vector< std::size_t > failed;
+        if( count == 0 )
+            return failed;
+
+        /* prefix[i] is the product of values[0..i] modulo n,
+         * skipping the values that are known to be non-invertible.
+         */
+        std::vector< bool > skip( count, false );
+        std::vector< T > prefix( count );
+        T accumulator(1);
+        for( std::size_t i = 0; i < count; i++ ) {
+            accumulator = accumulator * values[i] % n;
+            prefix[i] = accumulator;
+        }
+
+        if( math::gcd( accumulator, n ) != T(1) ) {
+            /* Some value shares a factor with n.
+             * Find the culprits and rebuild the products without them;
+             * this costs one gcd per value, but only in the failure case.
+             */
+            accumulator = T(1);
+            for( std::size_t i = 0; i < count; i++ ) {
+                if( math::gcd( T(values[i] % n), n ) != T(1) ) {
+                    skip[i] = true;
+                    failed.push_back( i );
+                }
+                else
+                    accumulator = accumulator * values[i] % n;
+                prefix[i] = accumulator;
+            }
+        }
+
+        // inverse is the inverse of prefix[i] during the iteration below.
+        T inverse = modular_inverse( T(accumulator % n), n );
+        for( std::size_t i = count; i-- > 0; ) {
+            if( skip[i] )
+                continue;
+            T value = values[i];
+            values[i] = i == 0 ? T(inverse) : T(inverse * prefix[i-1] % n);
+            inverse = inverse * value % n;
+        }
+        return failed;
+    }
+
 } // namespace math
 
 #endif // MATH_ALGO_HPP
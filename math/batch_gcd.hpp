@@ -0,0 +1,121 @@
+#ifndef MATH_BATCH_GCD_HPP
+#define MATH_BATCH_GCD_HPP
+
+/* Bernstein's batch GCD algorithm.
+ *
+ * Given moduli n_1, ..., n_k, the algorithm computes,
+ * for every i, the greatest common divisor between n_i
+ * and the product of all the other moduli.
+ * This exposes every modulus that shares a prime factor with another one
+ * in quasi-linear time, instead of the k^2 / 2 calls to math::gcd
+ * that would be needed to compare every pair.
+ *
+ * The algorithm works in two phases.
+ * First, a product tree is built: the leaves are the moduli
+ * and each node is the product of its children.
+ * Then, the product P at the root is reduced down the tree
+ * modulo the square of each node (the remainder tree),
+ * so that each leaf gets P mod n_i^2.
+ * Since n_i divides P, (P mod n_i^2) / n_i is the product of
+ * the other moduli modulo n_i, and its gcd with n_i is the answer.
+ */
+
+#include <cstddef>
+#include <vector>
+#include "math/algo.hpp"
+#include "parallel/parallel_for.hpp"
+
+namespace math {
+
+    /* A product tree is stored level by level.
+     * tree[0] holds the leaves, tree.back() holds only the root,
+     * and tree[l+1][i] == tree[l][2*i] * tree[l][2*i+1].
+     * A level with an odd number of nodes simply copies the last node upwards.
+     */
+    template< typename T >
+    using product_tree_t = std::vector< std::vector<T> >;
+
+    /* Builds the product tree of the given values.
+     * The nodes of each level are computed using the given number of threads.
+     *
+     * This algorithm assumes that leaves is not empty.
+     */
+    template< typename T >
+    product_tree_t<T> product_tree( std::vector<T> leaves, unsigned threads = 1 );
+
+    /* Reduces the root of the given product tree down to its leaves.
+     * The returned vector has, in position i,
+     * the value root mod tree[0][i]^2.
+     */
+    template< typename T >
+    std::vector<T> remainder_tree( const product_tree_t<T> & tree, unsigned threads = 1 );
+
+    /* Returns, in position i, the greatest common divisor between
+     * moduli[i] and the product of all the other moduli.
+     *
+     * A result different from 1 means moduli[i] shares a factor
+     * with some other modulus.
+     * If moduli[i] appears twice in the list, the result will be moduli[i] itself.
+     *
+     * Inside the function, we use values as large as
+     * the product of all the moduli, so choose T as to not overflow.
+     */
+    template< typename T >
+    std::vector<T> batch_gcd( const std::vector<T> & moduli, unsigned threads = 1 );
+
+// Implementation
+
+    template< typename T >
+    product_tree_t<T> product_tree( std::vector<T> leaves, unsigned threads ) {
+        product_tree_t<T> tree;
+        tree.push_back( std::move(leaves) );
+        while( tree.back().size() > 1 ) {
+            const std::vector<T> & below = tree.back();
+            std::vector<T> level( (below.size() + 1) / 2 );
+            parallel::parallel_for( 0, level.size(), threads,
+                [&]( std::size_t i, unsigned ) {
+                    if( 2*i + 1 < below.size() )
+                        level[i] = below[2*i] * below[2*i + 1];
+                    else
+                        level[i] = below[2*i];
+                }
+            );
+            tree.push_back( std::move(level) );
+        }
+        return tree;
+    }
+
+    template< typename T >
+    std::vector<T> remainder_tree( const product_tree_t<T> & tree, unsigned threads ) {
+        std::vector<T> remainders = tree.back();
+        for( std::size_t l = tree.size() - 1; l-- > 0; ) {
+            const std::vector<T> & level = tree[l];
+            std::vector<T> next( level.size() );
+            parallel::parallel_for( 0, level.size(), threads,
+                [&]( std::size_t i, unsigned ) {
+                    next[i] = remainders[i/2] % T(level[i] * level[i]);
+                }
+            );
+            remainders = std::move(next);
+        }
+        return remainders;
+    }
+
+    template< typename T >
+    std::vector<T> batch_gcd( const std::vector<T> & moduli, unsigned threads ) {
+        if( moduli.empty() )
+            return {};
+
+        std::vector<T> remainders = remainder_tree( product_tree( moduli, threads ), threads );
+        std::vector<T> gcds( moduli.size() );
+        parallel::parallel_for( 0, moduli.size(), threads,
+            [&]( std::size_t i, unsigned ) {
+                gcds[i] = math::gcd( T(remainders[i] / moduli[i]), moduli[i] );
+            }
+        );
+        return gcds;
+    }
+
+} // namespace math
+
+#endif // MATH_BATCH_GCD_HPP
@@ -0,0 +1,85 @@
+#ifndef MATH_EXPONENT_RING_HPP
+#define MATH_EXPONENT_RING_HPP
+
+/* Arithmetic on exponents of a cyclic group.
+ *
+ * If g belongs to a group of order n, then g^e = g^(e mod n),
+ * so exponents may be treated as elements of the ring Z_n.
+ * For the multiplicative group modulo a prime p, n = p-1.
+ *
+ * Keeping products of exponents reduced matters:
+ * the product of k unreduced exponents has k times as many bits,
+ * and so costs k times as many squarings to exponentiate.
+ */
+
+#include "math/algo.hpp"
+
+namespace math {
+
+    template< typename T >
+    class exponent_ring {
+        T n;
+
+    public:
+        /* Ring of the exponents of a group of the given order.
+         */
+        explicit exponent_ring( T order ) : n( order ) {}
+
+        const T & order() const { return n; }
+
+        // Returns the representative of e in [0, order).
+        T reduce( const T & e ) const;
+
+        T add( const T & a, const T & b ) const;
+        T multiply( const T & a, const T & b ) const;
+
+        /* Returns the product of every element of [begin, end),
+         * reduced after each multiplication.
+         * The product of an empty range is 1.
+         */
+        template< typename Iterator >
+        T product( Iterator begin, Iterator end ) const;
+
+        /* Returns the inverse of a; that is, the exponent that undoes
+         * the exponentiation by a. Requires gcd(a, order) == 1.
+         */
+        T inverse( const T & a ) const;
+    };
+
+// Implementation
+
+    template< typename T >
+    T exponent_ring<T>::reduce( const T & e ) const {
+        T r = e % n;
+        if( r < 0 )
+            r += n;
+        return r;
+    }
+
+    template< typename T >
+    T exponent_ring<T>::add( const T & a, const T & b ) const {
+        return reduce( T(a + b) );
+    }
+
+    template< typename T >
+    T exponent_ring<T>::multiply( const T & a, const T & b ) const {
+        return reduce( T(a * b) );
+    }
+
+    template< typename T >
+    template< typename Iterator >
+    T exponent_ring<T>::product( Iterator begin, Iterator end ) const {
+        T r = reduce( T(1) );
+        for( ; begin != end; ++begin )
+            r = multiply( r, *begin );
+        return r;
+    }
+
+    template< typename T >
+    T exponent_ring<T>::inverse( const T & a ) const {
+        return modular_inverse( reduce( a ), n );
+    }
+
+} // namespace math
+
+#endif // MATH_EXPONENT_RING_HPP
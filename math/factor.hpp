@@ -5,6 +5,7 @@
  */
 #include <vector>
 #include <utility>
+#include "instrument/instrument.hpp"
 #include "math/algo.hpp"
 #include "math/prime_list/list.h"
 #include "math/primality.hpp"
@@ -113,6 +114,7 @@ namespace math { namespace factor {
 
     template< typename T, typename RNG >
     factor_list<T> factor( T n, RNG rng ) {
+        instrument::scoped_timer timer( instrument::timer::factor );
         factor_list<T> ret = trial_division( n );
         if( n != T(1) )
             ret = merge_lists( ret, factor_notrial(n) );
@@ -146,6 +148,7 @@ namespace math { namespace factor {
 
         for( int k = 0; k < iterations; k++ ) {
             int divisor = prime_list::p[k];
+            instrument::count( instrument::counter::trial_divisions );
 
             if( n % divisor == 0 ) {
                 /* Found a prime factor.
@@ -212,7 +215,7 @@ namespace math { namespace factor {
          *  x_i = x_1 = f(x_0) = f(x_l_i).
          */
 
-        T d = gcd( T(n + x_i - x_l_i), n );
+        T d = math::gcd( T(n + x_i - x_l_i), n );
         /* d is the candidate to a divisor of n.
          * We will iterate until d == n,
          * in which the algorithm have failed.
@@ -242,8 +245,9 @@ namespace math { namespace factor {
             }
 
             ++i;
+            instrument::count( instrument::counter::rho_iterations );
             x_i = f(x_i) % n;
-            d = gcd( T(n + x_i - x_l_i), n );
+            d = math::gcd( T(n + x_i - x_l_i), n );
         }
 
         if( d == n ) {
@@ -0,0 +1,144 @@
+#ifndef MATH_FIXED_BASE_HPP
+#define MATH_FIXED_BASE_HPP
+
+/* Fixed-base modular exponentiation.
+ *
+ * When many powers g^e mod n are computed for the same g and n,
+ * the powers g^(d * 2^(w*i)), for every window i of w bits
+ * and every digit 0 < d < 2^w, may be computed once.
+ * Then, writing e in base 2^w as the digits e_i,
+ *      g^e = product of g^(e_i * 2^(w*i)),
+ * so each exponentiation costs one multiplication per window of e,
+ * instead of a squaring per bit plus a multiplication per set bit.
+ * For 2048-bit exponents and w = 5, this is 410 multiplications
+ * instead of about 3000 (see bench/fixed_base.cpp).
+ *
+ * The table has ceil(bits/w) * (2^w - 1) entries.
+ *
+ * File format:
+ * The base, the modulus, the number of exponent bits and the window,
+ * separated by whitespace; then, every entry of the table,
+ * one per line, in increasing order of window and digit.
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <gmpxx.h>
+#include "instrument/instrument.hpp"
+#include "math/algo.hpp"
+
+namespace math {
+
+    template< typename T >
+    class fixed_base {
+        T g, n;
+        std::uint32_t bits = 0;
+        unsigned w = 0;
+        std::vector< T > table; // g^(d * 2^(w*i)) is at table[i * (2^w - 1) + d - 1]
+
+    public:
+        // Empty table; pow cannot be used until a table is assigned or read.
+        fixed_base() = default;
+
+        /* Precomputes the table for exponents of up to exponent_bits bits.
+         * The window must be between 1 and 16.
+         */
+        fixed_base( T base, T modulus, std::uint32_t exponent_bits, unsigned window = 5 );
+
+        /* Computes base^exponent mod modulus.
+         * Exponents with more than exponent_bits bits (or negative ones)
+         * are delegated to math::pow_mod.
+         */
+        T pow( const T & exponent ) const;
+
+        bool empty() const { return table.empty(); }
+
+        // Returns true if this table computes powers of base modulo modulus.
+        bool matches( const T & base, const T & modulus ) const {
+            return !empty() && g == base && n == modulus;
+        }
+
+        const T & base() const { return g; }
+        const T & modulus() const { return n; }
+        std::uint32_t exponent_bits() const { return bits; }
+        unsigned window() const { return w; }
+
+        template< typename U >
+        friend std::ostream & operator<<( std::ostream &, const fixed_base<U> & );
+        template< typename U >
+        friend std::istream & operator>>( std::istream &, fixed_base<U> & );
+    };
+
+// Implementation
+
+    template< typename T >
+    fixed_base<T>::fixed_base( T base, T modulus, std::uint32_t exponent_bits, unsigned window ) :
+        g( base % modulus ),
+        n( modulus ),
+        bits( exponent_bits ),
+        w( window )
+    {
+        unsigned digits = (1u << w) - 1;
+        std::uint32_t windows = (bits + w - 1) / w;
+        table.reserve( windows * digits );
+
+        T row = g; // g^(2^(w*i))
+        for( std::uint32_t i = 0; i < windows; i++ ) {
+            table.push_back( row );
+            for( unsigned d = 2; d <= digits; d++ )
+                table.push_back( table.back() * row % n );
+            row = table.back() * row % n;
+        }
+    }
+
+    template< typename T >
+    T fixed_base<T>::pow( const T & exponent ) const {
+        if( exponent < 0 || bit_length( exponent ) > bits )
+            return pow_mod( g, exponent, n );
+
+        instrument::count( instrument::counter::pow_mod );
+        unsigned digits = (1u << w) - 1;
+        std::uint32_t windows = (bits + w - 1) / w;
+        T result( 1 );
+        bool first = true;
+        for( std::uint32_t i = 0; i < windows; i++ ) {
+            unsigned d = window_digit( exponent, i * w, w );
+            if( d == 0 )
+                continue;
+            if( first )
+                result = table[i * digits + d - 1];
+            else {
+                result = result * table[i * digits + d - 1] % n;
+                instrument::count( instrument::counter::multiplications );
+            }
+            first = false;
+        }
+        return result % n;
+    }
+
+    template< typename T >
+    std::ostream & operator<<( std::ostream & os, const fixed_base<T> & f ) {
+        os << f.g << ' ' << f.n << ' ' << f.bits << ' ' << f.w << '\n';
+        for( const T & entry : f.table )
+            os << entry << '\n';
+        return os;
+    }
+
+    template< typename T >
+    std::istream & operator>>( std::istream & is, fixed_base<T> & f ) {
+        if( !(is >> f.g >> f.n >> f.bits >> f.w) || f.w == 0 || f.w > 16 ) {
+            is.setstate( std::ios::failbit );
+            return is;
+        }
+        f.table.resize( std::size_t( (f.bits + f.w - 1) / f.w ) * ((1u << f.w) - 1) );
+        for( T & entry : f.table )
+            is >> entry;
+        if( !is )
+            f.table.clear();
+        return is;
+    }
+
+} // namespace math
+
+#endif // MATH_FIXED_BASE_HPP
@@ -1,11 +1,28 @@
 #ifndef MATH_GENERATE_PRIMES_HPP
 #define MATH_GENERATE_PRIMES_HPP
 
+#include <vector>
 #include "random/gmp_adapter.hpp"
+#include "math/algo.hpp"
+#include "math/factor.hpp"
+#include "math/prime_list/list.h"
 #include "math/primality.hpp"
 
 namespace math {
 
+    /* A prime number p together with the factor list of p-1.
+     *
+     * Knowing the factors of p-1 makes finding and testing
+     * primitive roots modulo p a matter of a few exponentiations
+     * (see math/primitive_root.hpp), instead of having to factor p-1,
+     * which is infeasible for primes with hundreds of digits.
+     */
+    template< typename T >
+    struct factored_prime {
+        T prime;
+        factor::factor_list<T> factors; // Factors of prime-1
+    };
+
     template< typename RNG >
     mpz_class generate_prime_number( RNG & rng, std::uint32_t bits, int trials ) {
         mpz_class number;
@@ -16,6 +33,198 @@ namespace math {
         return number;
     }
 
+    /* Generates a safe prime with the given number of bits;
+     * that is, a prime p such that q = (p-1)/2 is also prime.
+     * The returned factor list is {{2, 1}, {q, 1}}.
+     *
+     * Candidates for q are first sieved by the small primes,
+     * rejecting those for which either q or 2q+1 has a small factor,
+     * so that the Fermat test is run only on promising candidates.
+     *
+     * This algorithm assumes bits >= 3.
+     */
+    template< typename RNG >
+    factored_prime<mpz_class> generate_safe_prime(
+        RNG & rng,
+        std::uint32_t bits,
+        int trials
+    );
+
+    /* Generates a prime p with the given number of bits
+     * such that p-1 == 2 * q_1 * ... * q_r,
+     * in which every q_i is a prime with about factor_bits bits.
+     *
+     * Only the last factor is regenerated between attempts,
+     * and the candidates are sieved like in generate_safe_prime,
+     * so the cost is close to that of generating a safe prime.
+     *
+     * This algorithm assumes bits >= factor_bits + 4.
+     */
+    template< typename RNG >
+    factored_prime<mpz_class> generate_factored_prime(
+        RNG & rng,
+        std::uint32_t bits,
+        std::uint32_t factor_bits,
+        int trials
+    );
+
+    /* Parameters for a group of prime order q inside the integers modulo p:
+     * q divides p-1, and the generator has order exactly q.
+     */
+    template< typename T >
+    struct subgroup_prime {
+        T prime;
+        T order;     // q
+        T generator; // Element of order q
+    };
+
+    /* Generates a prime p with the given number of bits
+     * such that p-1 has a prime factor q with order_bits bits,
+     * in the manner of the DSA parameters:
+     * q is chosen first, and then p = 2kq + 1 for random k.
+     * The generator is h^((p-1)/q) for the smallest h >= 2 for which it is not 1.
+     *
+     * This algorithm assumes bits >= order_bits + 2.
+     */
+    template< typename RNG >
+    subgroup_prime<mpz_class> generate_subgroup_prime(
+        RNG & rng,
+        std::uint32_t bits,
+        std::uint32_t order_bits,
+        int trials
+    );
+
+// Implementation
+
+    /* Number of small primes used to sieve candidates
+     * before running the Fermat test on them.
+     */
+    constexpr int sieve_size = 2000;
+
+    /* Returns the residues of m modulo the first sieve_size odd primes.
+     */
+    inline std::vector< unsigned long > sieve_residues( const mpz_class & m ) {
+        std::vector< unsigned long > residues( sieve_size );
+        for( int k = 0; k < sieve_size; k++ )
+            residues[k] = mpz_fdiv_ui( m.get_mpz_t(), prime_list::p[k+1] );
+        return residues;
+    }
+
+    /* Returns false if either q or m*q+1 is divisible by
+     * one of the first sieve_size odd primes (other than the number itself),
+     * where m_residues == sieve_residues(m).
+     */
+    inline bool sieve( const mpz_class & q, const std::vector< unsigned long > & m_residues ) {
+        for( int k = 0; k < sieve_size; k++ ) {
+            unsigned long p = prime_list::p[k+1];
+            if( q <= p )
+                return true;
+            unsigned long r = mpz_fdiv_ui( q.get_mpz_t(), p );
+            if( r == 0 || (m_residues[k] * r + 1) % p == 0 )
+                return false;
+        }
+        return true;
+    }
+
+    template< typename RNG >
+    factored_prime<mpz_class> generate_safe_prime(
+        RNG & rng,
+        std::uint32_t bits,
+        int trials
+    ) {
+        auto residues = sieve_residues( 2 );
+        mpz_class q;
+        do {
+            q = rng::gmp_generate( rng, bits - 1 );
+            q |= 1;
+        } while( !sieve( q, residues ) ||
+                 !math::primality::fermat( q, rng, trials ) ||
+                 !math::primality::fermat( mpz_class(2*q + 1), rng, trials ) );
+
+        return { 2*q + 1, {{2, 1}, {q, 1}} };
+    }
+
+    template< typename RNG >
+    factored_prime<mpz_class> generate_factored_prime(
+        RNG & rng,
+        std::uint32_t bits,
+        std::uint32_t factor_bits,
+        int trials
+    ) {
+        // Fixed part of p-1: 2 times every factor but the last one.
+        mpz_class fixed = 2;
+        factor::factor_list<mpz_class> factors = {{2, 1}};
+        while( mpz_sizeinbase( fixed.get_mpz_t(), 2 ) + 2*factor_bits < bits ) {
+            mpz_class q = generate_prime_number( rng, factor_bits, trials );
+            fixed *= q;
+            factor::add_factor( factors, q );
+        }
+
+        /* The product of an F-bit and an L-bit number has F+L-1 or F+L bits,
+         * so sizes that overshoot are simply rejected below.
+         */
+        std::uint32_t last_bits = bits + 1 - mpz_sizeinbase( fixed.get_mpz_t(), 2 );
+        auto residues = sieve_residues( fixed );
+        mpz_class q, p;
+        while( true ) {
+            q = rng::gmp_generate( rng, last_bits );
+            q |= 1;
+            p = fixed * q + 1;
+            if( mpz_sizeinbase( p.get_mpz_t(), 2 ) == bits &&
+                sieve( q, residues ) &&
+                math::primality::fermat( q, rng, trials ) &&
+                math::primality::fermat( p, rng, trials ) )
+                break;
+        }
+        factor::add_factor( factors, q );
+        return { p, factors };
+    }
+
+    template< typename RNG >
+    subgroup_prime<mpz_class> generate_subgroup_prime(
+        RNG & rng,
+        std::uint32_t bits,
+        std::uint32_t order_bits,
+        int trials
+    ) {
+        /* p = 2kq + 1 has `bits` bits exactly when k lies in [low, high).
+         * Candidates with p divisible by a small prime are skipped.
+         * If bits is close to order_bits, the range may hold few values of k
+         * (or none) and none of them may give a prime,
+         * so a new q is drawn after a bounded number of candidates.
+         */
+        mpz_class q, k, p;
+        bool found = false;
+        while( !found ) {
+            q = generate_prime_number( rng, order_bits, trials );
+            mpz_class low = ((mpz_class(1) << (bits - 1)) + 2*q - 1) / (2*q);
+            mpz_class high = ((mpz_class(1) << bits) - 1) / (2*q) + 1;
+            mpz_class range = high - low;
+            if( range <= 0 )
+                continue;
+            std::uint32_t range_bits = mpz_sizeinbase( range.get_mpz_t(), 2 );
+            auto residues = sieve_residues( mpz_class(2*q) );
+            for( std::uint32_t attempt = 0; attempt < 4 * bits && !found; attempt++ ) {
+                k = low + rng::gmp_generate( rng, range_bits + 64 ) % range;
+                bool small_factor = false;
+                for( int i = 0; i < sieve_size && !small_factor; i++ ) {
+                    unsigned long s = prime_list::p[i+1];
+                    small_factor = (residues[i] * mpz_fdiv_ui( k.get_mpz_t(), s ) + 1) % s == 0;
+                }
+                p = 2*k*q + 1;
+                found = !small_factor && math::primality::fermat( p, rng, trials );
+            }
+        }
+
+        mpz_class cofactor = (p - 1) / q, g;
+        for( mpz_class h = 2; ; h++ ) {
+            g = math::pow_mod( h, cofactor, p );
+            if( g != 1 )
+                break;
+        }
+        return { p, q, g };
+    }
+
 }
 
 #endif // MATH_GENERATE_PRIMES_HPP
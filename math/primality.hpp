@@ -2,6 +2,7 @@
 #define MATH_PRIMALITY_HPP
 
 #include <gmpxx.h>
+#include "instrument/instrument.hpp"
 #include "math/algo.hpp"
 #include "random/gmp_adapter.hpp"
 
@@ -36,6 +37,7 @@ bool fermat( mpz_class number, RNG& rng, int trials, mpz_class * witness = nullp
 
 template< typename RNG >
 bool fermat( mpz_class number, RNG& rng, int trials, mpz_class * witness ) {
+    instrument::scoped_timer timer( instrument::timer::fermat );
     mpz_class power, witness_candidate;
 
     int bits = mpz_sizeinbase( number.get_mpz_t(), 2 );
@@ -48,6 +50,7 @@ bool fermat( mpz_class number, RNG& rng, int trials, mpz_class * witness ) {
         witness_candidate += 1;
 
         // Test witness
+        instrument::count( instrument::counter::fermat_trials );
         power = math::pow_mod( witness_candidate, number_minus_one, number );
 
         if( power != 1 ) {
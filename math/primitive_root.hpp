@@ -1,8 +1,11 @@
 #ifndef MATH_PRIMITIVE_ROOT_HPP
 #define MATH_PRIMITIVE_ROOT_HPP
 
+#include <vector>
 #include "math/algo.hpp"
 #include "math/factor.hpp"
+#include "math/fixed_base.hpp"
+#include "parallel/parallel_for.hpp"
 
 namespace math {
     /* Returns true if a is a primitive root modulo p,
@@ -29,11 +32,15 @@ namespace math {
     }
 
     /* Returns the smallest primitive root modulo p,
-     * assuming p is prime,
+     * assuming p is prime and factors is the factor list of p-1,
      * or 0 if no primitive root could be found.
+     *
+     * This is the only feasible way of finding primitive roots
+     * of large primes; see math/generate_primes.hpp
+     * for ways of generating primes with known factorization of p-1.
      */
     template< typename T >
-    T primitive_root_modulo_p( T p ) {
+    T primitive_root_modulo_p( T p, const factor::factor_list<T> & factors ) {
         /* 2 is the only number for which 1 is a primitive root.
          * Since 1 is also the only primitive root modulo 2,
          * the algorithm below would fail for p == 2
@@ -42,8 +49,6 @@ namespace math {
         if( p == T(2) )
             return T(1);
 
-        auto factors = math::factor::factor( T(p-1) );
-
         for( T candidate(2); candidate < p; candidate++ )
             if( is_primitive_root_modulo_p(candidate, p, factors) )
                 return candidate;
@@ -52,42 +57,214 @@ namespace math {
         return T(0);
     }
 
+    /* Same as above, but factors p-1 first.
+     */
+    template< typename T >
+    T primitive_root_modulo_p( T p ) {
+        return primitive_root_modulo_p( p, math::factor::factor( T(p-1) ) );
+    }
+
+    /* Lazily enumerates the primitive roots a^m modulo a prime p,
+     * for the exponents m in the range [first, last] that are coprime with p-1,
+     * in increasing order of m.
+     * a must be a primitive root modulo p
+     * and factors must be the factor list of p-1.
+     *
+     * The coprimality of m is tested against the prime factors of p-1,
+     * and each root is obtained from the previous one
+     * by a single multiplication by a^(gap between the exponents);
+     * these powers of a are computed once and cached.
+     * Only the first root of the range costs a full exponentiation.
+     */
+    template< typename T >
+    class primitive_root_generator {
+        T p, a;
+        T m, last;
+        T current; // a^m mod p
+        bool started = false;
+        std::vector< T > primes; // Prime factors of p-1
+        std::vector< T > powers; // powers[d] == a^d mod p
+
+        bool coprime_with_phi( const T & m ) const;
+
+    public:
+        /* If last is zero, it is taken to be p-1,
+         * so that the default range enumerates every primitive root.
+         */
+        primitive_root_generator(
+            T p,
+            T a,
+            const factor::factor_list<T> & factors,
+            T first = T(1),
+            T last = T(0)
+        );
+
+        /* Stores the next primitive root in root and returns true,
+         * or returns false if the range is exhausted.
+         */
+        bool next( T & root );
+    };
+
     /* Given a primitive root a modulo a prime p,
      * this algorithm generates all primitive roots modulo p,
      * in no specified order.
+     *
+     * This function stores the whole list in memory;
+     * use primitive_root_generator or enumerate_primitive_roots
+     * for large primes.
      */
     template< typename T >
     std::vector< T > all_primitive_roots_modulo_p( T p, T a ) {
-        std::vector< T > primitive_roots = {a};
-        T phi = p-1;
-        for( T m(2); m < p; m++ ) {
-            /* It can be shown that, if a is a primitive root modulo p,
-             * then a^m mod p is another primitive root
-             * if and only if m is coprime with phi(p) == p-1.
-             *
-             * Since a is a primitive root,
-             * every number modulo p will be a^m for some m,
-             * so this algorithm correctly returns every primitive root modulo p.
-             */
-            if( math::gcd( m, phi ) == T(1) )
-                primitive_roots.push_back( math::pow_mod( a, m, p ) );
-        }
-
+        /* It can be shown that, if a is a primitive root modulo p,
+         * then a^m mod p is another primitive root
+         * if and only if m is coprime with phi(p) == p-1.
+         *
+         * Since a is a primitive root,
+         * every number modulo p will be a^m for some m,
+         * so this algorithm correctly returns every primitive root modulo p.
+         */
+        std::vector< T > primitive_roots;
+        primitive_root_generator< T > generator( p, a, math::factor::factor( T(p-1) ) );
+        T root;
+        while( generator.next( root ) )
+            primitive_roots.push_back( root );
         return primitive_roots;
     }
 
-    /* Generates a random primitive root modulo p,
-     * given a known pririmitive root a.
+    /* Calls consume(roots) with consecutive slices of the primitive roots
+     * modulo p, in the same order as primitive_root_generator.
+     *
+     * The exponent range is split into blocks of block_size exponents,
+     * and 'threads' blocks are enumerated in parallel at a time;
+     * thus, at most threads * block_size roots are held in memory.
+     */
+    template< typename T, typename F >
+    void enumerate_primitive_roots(
+        T p,
+        T a,
+        const factor::factor_list<T> & factors,
+        unsigned threads,
+        unsigned long block_size,
+        F consume
+    );
+
+    /* Generates a random number, with as many bits as phi,
+     * that is coprime with phi.
      */
     template< typename T, typename RNG >
-    T random_primitive_root_modulo_p( T p, T a, RNG & rng ) {
-        T phi = p-1;
+    T random_coprime( T phi, RNG & rng ) {
         int bits = mpz_sizeinbase( phi.get_mpz_t(), 2 );
         T power = rng::gmp_generate( rng, bits );
         while( math::gcd( power, phi ) != T(1) )
             power = rng::gmp_generate( rng, bits );
+        return power;
+    }
+
+    /* Generates a random primitive root modulo p,
+     * given a known pririmitive root a.
+     */
+    template< typename T, typename RNG >
+    T random_primitive_root_modulo_p( T p, T a, RNG & rng ) {
+        return math::pow_mod( a, random_coprime( T(p-1), rng ), p );
+    }
+
+    /* Same as above, where a and p are the base and the modulus
+     * of the given fixed-base table, which is used to compute the power.
+     */
+    template< typename T, typename RNG >
+    T random_primitive_root_modulo_p( const fixed_base<T> & f, RNG & rng ) {
+        return f.pow( random_coprime( T(f.modulus() - 1), rng ) );
+    }
+
+// Implementation
 
-        return math::pow_mod( a, power, p );
+    template< typename T >
+    primitive_root_generator<T>::primitive_root_generator(
+        T p,
+        T a,
+        const factor::factor_list<T> & factors,
+        T first,
+        T last
+    ) :
+        p( p ),
+        a( a % p ),
+        m( first ),
+        last( last == T(0) ? T(p-1) : last ),
+        powers{ T(1) }
+    {
+        for( const auto & pair : factors )
+            primes.push_back( pair.first );
+    }
+
+    template< typename T >
+    bool primitive_root_generator<T>::coprime_with_phi( const T & m ) const {
+        for( const T & prime : primes )
+            if( m % prime == 0 )
+                return false;
+        return true;
+    }
+
+    template< typename T >
+    bool primitive_root_generator<T>::next( T & root ) {
+        unsigned gap = 0;
+        if( started ) {
+            ++m;
+            ++gap;
+        }
+        while( m <= last && !coprime_with_phi( m ) ) {
+            ++m;
+            ++gap;
+        }
+        if( m > last )
+            return false;
+
+        if( !started ) {
+            started = true;
+            current = math::pow_mod( a, m, p );
+        }
+        else {
+            while( powers.size() <= gap )
+                powers.push_back( T(powers.back() * a % p) );
+            current = current * powers[gap] % p;
+        }
+        root = current;
+        return true;
+    }
+
+    template< typename T, typename F >
+    void enumerate_primitive_roots(
+        T p,
+        T a,
+        const factor::factor_list<T> & factors,
+        unsigned threads,
+        unsigned long block_size,
+        F consume
+    ) {
+        if( threads == 0 )
+            threads = 1;
+        T phi = p - 1;
+        std::vector< std::vector<T> > blocks( threads );
+
+        for( T begin(1); begin <= phi; begin += T(threads * block_size) ) {
+            parallel::parallel_for( 0, threads, threads,
+                [&]( std::size_t i, unsigned ) {
+                    blocks[i].clear();
+                    T first = begin + T(i * block_size);
+                    if( first > phi )
+                        return;
+                    T last = first + T(block_size - 1);
+                    if( last > phi )
+                        last = phi;
+
+                    primitive_root_generator<T> generator( p, a, factors, first, last );
+                    T root;
+                    while( generator.next( root ) )
+                        blocks[i].push_back( root );
+                }
+            );
+            for( const auto & block : blocks )
+                consume( block );
+        }
     }
 
 } // namespace math
@@ -5,30 +5,92 @@
  */
 
 #include <algorithm>
+#include <cstdint>
 #include <vector>
 
 namespace math {
 
+    /* Returns the binomial coefficient C(n, k),
+     * or 0 if k < 0 or k > n.
+     *
+     * The result must fit in 64 bits.
+     */
+    inline std::uint64_t binomial( int n, int k );
+
+    /* Iterator over the subsets of size k of the set {0, 1, ..., n-1},
+     * in lexicographic order.
+     *
+     * Each combination is held as a sorted vector of k indexes,
+     * allocated once in the constructor;
+     * advancing the iterator or jumping to an arbitrary position
+     * does not allocate memory.
+     *
+     * Every combination has a rank, which is its position
+     * in the lexicographic order, starting from zero.
+     * The combination of a given rank can be obtained directly (unranking),
+     * so the enumeration may be split into ranges
+     * that are processed independently.
+     */
+    class combination {
+        int n;
+        std::vector<int> c;
+        std::uint64_t r;
+
+    public:
+        /* Constructs the first combination, {0, 1, ..., k-1}.
+         * This class assumes 0 <= k <= n.
+         */
+        combination( int n, int k );
+
+        /* Constructs the combination with the given rank.
+         */
+        combination( int n, int k, std::uint64_t rank );
+
+        // The sorted indexes that compose this combination.
+        const std::vector<int> & indexes() const { return c; }
+
+        // Position of this combination in the lexicographic order.
+        std::uint64_t rank() const { return r; }
+
+        /* Advances to the next combination in lexicographic order.
+         * Returns false (and leaves the combination untouched)
+         * if this was the last one.
+         */
+        bool next();
+
+        /* Jumps to the combination with the given rank.
+         * This algorithm assumes rank < binomial(n, k).
+         */
+        void unrank( std::uint64_t rank );
+
+        /* Returns the rank of the given combination of size indexes.size()
+         * of the set {0, 1, ..., n-1}.
+         * The indexes must be sorted and distinct.
+         */
+        static std::uint64_t rank_of( int n, const std::vector<int> & indexes );
+    };
+
     /* Returns all the subsets of the given size
      * for the given set.
      *
-     * This algorithm assumes that size >= set.size().
+     * The subsets are produced by a combination iterator,
+     * so each subset lists its elements in the same order as the set.
+     *
+     * If size is negative or greater than set.size(),
+     * there are no such subsets, and the returned list is empty.
      */
     template< typename T >
     std::vector< std::vector<T> > subsets( std::vector<T> set, int size ) {
-        if( size == 0 )
-            // There is only one subset with size zero.
-            return {{}};
-
         std::vector< std::vector<T> > ret_val;
-        for( int i = 0; i + size <= set.size(); i++ ) {
-            std::vector<T> remainder( set.begin() + i + 1, set.end() );
-            auto smaller_subsets = subsets( remainder, size - 1 );
-            for( auto subset : smaller_subsets ) {
-                subset.push_back( set[i] );
-                ret_val.push_back( subset );
-            }
-        }
+        if( size < 0 || size > (int) set.size() )
+            return ret_val;
+        combination c( set.size(), size );
+        do {
+            std::vector<T> subset;
+            for( int index : c.indexes() )
+                subset.push_back( set[index] );
+            ret_val.push_back( subset );
+        } while( c.next() );
         return ret_val;
     }
 
@@ -37,11 +99,92 @@ namespace math {
      */
     template< typename T >
     std::vector< std::vector<T> > sorted_subsets( std::vector<T> set, int size ) {
-        auto r = subsets( set, size );
-        for( auto & a : r )
-            std::sort( a.begin(), a.end() );
-        std::sort( r.begin(), r.end() );
+        /* Since the combinations are generated in lexicographic order,
+         * sorting the set is enough to get every subset already sorted,
+         * and the list of subsets sorted as well.
+         */
+        std::sort( set.begin(), set.end() );
+        return subsets( set, size );
+    }
+
+// Implementation
+
+    inline std::uint64_t binomial( int n, int k ) {
+        if( k < 0 || k > n )
+            return 0;
+        if( k > n - k )
+            k = n - k;
+        std::uint64_t r = 1;
+        for( int i = 1; i <= k; i++ )
+            /* r * (n-k+i) is always divisible by i,
+             * but may exceed 64 bits even if the quotient does not.
+             */
+            r = (unsigned __int128) r * (n - k + i) / i;
         return r;
     }
+
+    inline combination::combination( int n, int k ) :
+        n( n ),
+        c( k ),
+        r( 0 )
+    {
+        for( int i = 0; i < k; i++ )
+            c[i] = i;
+    }
+
+    inline combination::combination( int n, int k, std::uint64_t rank ) :
+        n( n ),
+        c( k )
+    {
+        unrank( rank );
+    }
+
+    inline bool combination::next() {
+        int k = c.size();
+        /* Find the rightmost index that can still be incremented;
+         * the index in position i can be at most n-k+i.
+         */
+        int i = k - 1;
+        while( i >= 0 && c[i] == n - k + i )
+            i--;
+        if( i < 0 )
+            return false;
+
+        c[i]++;
+        for( int j = i + 1; j < k; j++ )
+            c[j] = c[j-1] + 1;
+        r++;
+        return true;
+    }
+
+    /* Ranking uses the combinatorial number system:
+     * the lexicographic rank of c_0 < c_1 < ... < c_{k-1} is
+     *  C(n, k) - 1 - sum_i C(n-1-c_i, k-i).
+     */
+    inline std::uint64_t combination::rank_of( int n, const std::vector<int> & indexes ) {
+        int k = indexes.size();
+        std::uint64_t sum = 0;
+        for( int i = 0; i < k; i++ )
+            sum += binomial( n - 1 - indexes[i], k - i );
+        return binomial( n, k ) - 1 - sum;
+    }
+
+    inline void combination::unrank( std::uint64_t rank ) {
+        int k = c.size();
+        r = rank;
+        std::uint64_t remainder = binomial( n, k ) - 1 - rank;
+        /* Greedily choose, for each position, the largest x = n-1-c_i
+         * such that C(x, k-i) still fits in the remainder.
+         */
+        int x = n;
+        for( int i = 0; i < k; i++ ) {
+            do
+                x--;
+            while( binomial( x, k - i ) > remainder );
+            remainder -= binomial( x, k - i );
+            c[i] = n - 1 - x;
+        }
+    }
+
 }
 #endif // MATH_SET_HPP
@@ -0,0 +1,192 @@
+#ifndef NET_SOCKET_HPP
+#define NET_SOCKET_HPP
+
+/* Thin wrappers over the POSIX socket calls used by the network services.
+ *
+ * Only local endpoints are supported:
+ * Unix domain sockets and TCP on the loopback interface.
+ * Every function that opens a socket throws std::system_error on failure.
+ */
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace net {
+
+    /* Local address of a stream socket.
+     */
+    struct endpoint {
+        bool unix_socket = true;
+        std::string path;        // For Unix sockets
+        std::uint16_t port = 0;  // For TCP, always on 127.0.0.1
+    };
+
+    /* Parses "unix:<path>" or "<port>".
+     * Throws std::invalid_argument for anything else.
+     */
+    inline endpoint parse_endpoint( const std::string & );
+
+    inline std::string to_string( const endpoint & );
+
+    /* Creates a non-blocking socket listening on the given endpoint.
+     * A stale Unix socket file is removed first.
+     */
+    inline int listen_on( const endpoint &, int backlog = SOMAXCONN );
+
+    /* Starts a non-blocking connection to the endpoint.
+     * Returns the socket, and sets in_progress if the connection
+     * is not established yet (the socket becomes writable when it is).
+     * Returns -1 and sets errno if the connection could not be started;
+     * EAGAIN means that the listen backlog of a Unix socket is full.
+     */
+    inline int start_connect( const endpoint &, bool & in_progress );
+
+    // Opens a blocking connection to the endpoint.
+    inline int connect_to( const endpoint & );
+
+    inline void set_nonblocking( int fd );
+
+    /* Raises the limit of open files to its hard maximum,
+     * so that thousands of connections can be open at once.
+     * Returns the new limit.
+     */
+    inline std::size_t raise_file_limit();
+
+// Implementation
+
+    endpoint parse_endpoint( const std::string & str ) {
+        endpoint e;
+        if( str.compare( 0, 5, "unix:" ) == 0 && str.size() > 5 ) {
+            e.path = str.substr( 5 );
+            if( e.path.size() >= sizeof(sockaddr_un::sun_path) )
+                throw std::invalid_argument( "Socket path too long: " + e.path );
+            return e;
+        }
+        std::size_t end;
+        unsigned long port;
+        try {
+            port = std::stoul( str, &end );
+        } catch( std::exception & ) {
+            end = 0;
+        }
+        if( end == 0 || end != str.size() || port == 0 || port > 65535 )
+            throw std::invalid_argument( "Endpoint must be unix:<path> or a port: " + str );
+        e.unix_socket = false;
+        e.port = port;
+        return e;
+    }
+
+    std::string to_string( const endpoint & e ) {
+        if( e.unix_socket )
+            return "unix:" + e.path;
+        return "127.0.0.1:" + std::to_string( e.port );
+    }
+
+    // Fills addr with the address of the endpoint and returns its length.
+    inline socklen_t socket_address( const endpoint & e, sockaddr_storage & addr ) {
+        std::memset( &addr, 0, sizeof addr );
+        if( e.unix_socket ) {
+            sockaddr_un * un = (sockaddr_un *) &addr;
+            un->sun_family = AF_UNIX;
+            std::strncpy( un->sun_path, e.path.c_str(), sizeof un->sun_path - 1 );
+            return sizeof *un;
+        }
+        sockaddr_in * in = (sockaddr_in *) &addr;
+        in->sin_family = AF_INET;
+        in->sin_port = htons( e.port );
+        in->sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+        return sizeof *in;
+    }
+
+    inline int new_socket( const endpoint & e, int flags ) {
+        int fd = socket( e.unix_socket ? AF_UNIX : AF_INET, SOCK_STREAM | flags, 0 );
+        if( fd < 0 )
+            throw std::system_error( errno, std::system_category(), "socket" );
+        if( !e.unix_socket ) {
+            int one = 1;
+            setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one );
+        }
+        return fd;
+    }
+
+    int listen_on( const endpoint & e, int backlog ) {
+        int fd = new_socket( e, SOCK_NONBLOCK | SOCK_CLOEXEC );
+        if( e.unix_socket )
+            unlink( e.path.c_str() );
+        else {
+            int one = 1;
+            setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one );
+        }
+
+        sockaddr_storage addr;
+        socklen_t length = socket_address( e, addr );
+        if( bind( fd, (sockaddr *) &addr, length ) != 0 || listen( fd, backlog ) != 0 ) {
+            int error = errno;
+            close( fd );
+            throw std::system_error( error, std::system_category(),
+                "Could not listen on " + to_string( e ) );
+        }
+        return fd;
+    }
+
+    int start_connect( const endpoint & e, bool & in_progress ) {
+        int fd = new_socket( e, SOCK_NONBLOCK | SOCK_CLOEXEC );
+        sockaddr_storage addr;
+        socklen_t length = socket_address( e, addr );
+        in_progress = false;
+        if( connect( fd, (sockaddr *) &addr, length ) == 0 )
+            return fd;
+        if( errno == EINPROGRESS ) {
+            in_progress = true;
+            return fd;
+        }
+        int error = errno;
+        close( fd );
+        errno = error;
+        return -1;
+    }
+
+    int connect_to( const endpoint & e ) {
+        int fd = new_socket( e, SOCK_CLOEXEC );
+        sockaddr_storage addr;
+        socklen_t length = socket_address( e, addr );
+        if( connect( fd, (sockaddr *) &addr, length ) != 0 ) {
+            int error = errno;
+            close( fd );
+            throw std::system_error( error, std::system_category(),
+                "Could not connect to " + to_string( e ) );
+        }
+        return fd;
+    }
+
+    void set_nonblocking( int fd ) {
+        fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+    }
+
+    std::size_t raise_file_limit() {
+        rlimit limit;
+        if( getrlimit( RLIMIT_NOFILE, &limit ) != 0 )
+            return 0;
+        if( limit.rlim_cur < limit.rlim_max ) {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit( RLIMIT_NOFILE, &limit );
+            getrlimit( RLIMIT_NOFILE, &limit );
+        }
+        return limit.rlim_cur;
+    }
+
+} // namespace net
+
+#endif // NET_SOCKET_HPP
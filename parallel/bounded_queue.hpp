@@ -0,0 +1,140 @@
+#ifndef PARALLEL_BOUNDED_QUEUE_HPP
+#define PARALLEL_BOUNDED_QUEUE_HPP
+
+/* Lock-free bounded queue.
+ *
+ * This is Dmitry Vyukov's bounded multi-producer, multi-consumer queue:
+ * a ring of cells, each with a sequence number that tells
+ * whether the cell is ready to be written or read in the current lap.
+ * Producers and consumers claim positions with a compare-and-swap
+ * on their own counter, so neither side ever blocks or takes a lock,
+ * and a push or pop that does not contend costs a few atomic operations.
+ *
+ * Unlike parallel::channel, nothing waits: try_push fails when the queue
+ * is full, and try_pop fails when it is empty.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace parallel {
+
+    template< typename T >
+    class bounded_queue {
+    public:
+        /* Queue for at least capacity values;
+         * the capacity is rounded up to a power of two (and at least 2).
+         */
+        explicit bounded_queue( std::size_t capacity );
+
+        bounded_queue( const bounded_queue & ) = delete;
+        bounded_queue & operator=( const bounded_queue & ) = delete;
+
+        /* Moves value into the queue and returns true,
+         * or returns false, leaving value untouched, if the queue is full.
+         */
+        bool try_push( T && value );
+
+        /* Moves the oldest value of the queue into value and returns true,
+         * or returns false if the queue is empty.
+         */
+        bool try_pop( T & value );
+
+        std::size_t capacity() const { return mask + 1; }
+
+        /* Number of values in the queue.
+         * It is exact only if no other thread is using the queue.
+         */
+        std::size_t size() const;
+
+    private:
+        struct cell {
+            std::atomic< std::size_t > sequence;
+            T value;
+        };
+
+        std::unique_ptr< cell[] > cells;
+        std::size_t mask;
+
+        /* Kept in separate cache lines, so producers and consumers do not contend.
+         * Padding, rather than alignas, keeps them apart wherever the queue lives:
+         * before C++17, operator new ignores over-aligned types.
+         */
+        static constexpr std::size_t cache_line = 64;
+        char pad0[cache_line];
+        std::atomic< std::size_t > tail{ 0 }; // Next position to push
+        char pad1[cache_line];
+        std::atomic< std::size_t > head{ 0 }; // Next position to pop
+        char pad2[cache_line];
+    };
+
+// Implementation
+
+    template< typename T >
+    bounded_queue<T>::bounded_queue( std::size_t capacity ) {
+        std::size_t size = 2;
+        while( size < capacity )
+            size *= 2;
+        mask = size - 1;
+        cells.reset( new cell[size] );
+        for( std::size_t i = 0; i < size; i++ )
+            cells[i].sequence.store( i, std::memory_order_relaxed );
+    }
+
+    template< typename T >
+    bool bounded_queue<T>::try_push( T && value ) {
+        std::size_t pos = tail.load( std::memory_order_relaxed );
+        cell * c;
+        while( true ) {
+            c = &cells[pos & mask];
+            std::size_t seq = c->sequence.load( std::memory_order_acquire );
+            std::intptr_t diff = (std::intptr_t) seq - (std::intptr_t) pos;
+            if( diff == 0 ) {
+                if( tail.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+                    break;
+            }
+            else if( diff < 0 )
+                return false; // The cell still holds the value of the previous lap
+            else
+                pos = tail.load( std::memory_order_relaxed );
+        }
+        c->value = std::move( value );
+        c->sequence.store( pos + 1, std::memory_order_release );
+        return true;
+    }
+
+    template< typename T >
+    bool bounded_queue<T>::try_pop( T & value ) {
+        std::size_t pos = head.load( std::memory_order_relaxed );
+        cell * c;
+        while( true ) {
+            c = &cells[pos & mask];
+            std::size_t seq = c->sequence.load( std::memory_order_acquire );
+            std::intptr_t diff = (std::intptr_t) seq - (std::intptr_t) (pos + 1);
+            if( diff == 0 ) {
+                if( head.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+                    break;
+            }
+            else if( diff < 0 )
+                return false; // The cell was not written in this lap yet
+            else
+                pos = head.load( std::memory_order_relaxed );
+        }
+        value = std::move( c->value );
+        c->sequence.store( pos + mask + 1, std::memory_order_release );
+        return true;
+    }
+
+    template< typename T >
+    std::size_t bounded_queue<T>::size() const {
+        std::size_t h = head.load( std::memory_order_acquire );
+        std::size_t t = tail.load( std::memory_order_acquire );
+        return t > h ? t - h : 0;
+    }
+
+} // namespace parallel
+
+#endif // PARALLEL_BOUNDED_QUEUE_HPP
@@ -0,0 +1,89 @@
+#ifndef PARALLEL_CHANNEL_HPP
+#define PARALLEL_CHANNEL_HPP
+
+/* Queue for passing values between threads.
+ */
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace parallel {
+
+    /* Unbounded multi-producer, multi-consumer FIFO channel.
+     *
+     * Producers push values; consumers block in pop
+     * until a value is available or the channel is closed.
+     */
+    template< typename T >
+    class channel {
+        std::deque< T > queue;
+        std::mutex mutex;
+        std::condition_variable available;
+        bool closed = false;
+
+    public:
+        // Adds a value to the channel.
+        void push( T value );
+
+        /* Removes the oldest value of the channel and stores it in value.
+         * Blocks while the channel is empty;
+         * returns false if the channel was closed and there are no more values.
+         */
+        bool pop( T & value );
+
+        /* Like pop, but returns false at once if the channel is empty.
+         */
+        bool try_pop( T & value );
+
+        /* Wakes every consumer; after the remaining values are popped,
+         * pop returns false.
+         */
+        void close();
+    };
+
+// Implementation
+
+    template< typename T >
+    void channel<T>::push( T value ) {
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+            queue.push_back( std::move(value) );
+        }
+        available.notify_one();
+    }
+
+    template< typename T >
+    bool channel<T>::pop( T & value ) {
+        std::unique_lock< std::mutex > lock( mutex );
+        available.wait( lock, [this]() { return closed || !queue.empty(); } );
+        if( queue.empty() )
+            return false;
+        value = std::move( queue.front() );
+        queue.pop_front();
+        return true;
+    }
+
+    template< typename T >
+    bool channel<T>::try_pop( T & value ) {
+        std::lock_guard< std::mutex > lock( mutex );
+        if( queue.empty() )
+            return false;
+        value = std::move( queue.front() );
+        queue.pop_front();
+        return true;
+    }
+
+    template< typename T >
+    void channel<T>::close() {
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+            closed = true;
+        }
+        available.notify_all();
+    }
+
+} // namespace parallel
+
+#endif // PARALLEL_CHANNEL_HPP
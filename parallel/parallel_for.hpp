@@ -0,0 +1,103 @@
+#ifndef PARALLEL_PARALLEL_FOR_HPP
+#define PARALLEL_PARALLEL_FOR_HPP
+
+/* Minimal tools for spreading independent work over several threads.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+    /* Returns the number of threads the hardware can run concurrently,
+     * or 1 if this number could not be determined.
+     */
+    inline unsigned default_threads();
+
+    /* Calls f(i, worker) for every i in [begin, end).
+     *
+     * The indexes are handed out in chunks of the given size
+     * to 'threads' worker threads, as each worker becomes idle;
+     * 'worker' is the number of the thread that is running the call,
+     * in the range [0, threads), and may be used to index per-thread state.
+     * The calls happen in no particular order.
+     *
+     * If threads <= 1, everything runs in the calling thread.
+     * If some call throws, the remaining chunks are abandoned
+     * and the first exception is rethrown in the calling thread.
+     */
+    template< typename F >
+    void parallel_for(
+        std::size_t begin,
+        std::size_t end,
+        unsigned threads,
+        F f,
+        std::size_t chunk = 1
+    );
+
+// Implementation
+
+    inline unsigned default_threads() {
+        unsigned n = std::thread::hardware_concurrency();
+        return n == 0 ? 1 : n;
+    }
+
+    template< typename F >
+    void parallel_for(
+        std::size_t begin,
+        std::size_t end,
+        unsigned threads,
+        F f,
+        std::size_t chunk
+    ) {
+        if( chunk == 0 )
+            chunk = 1;
+
+        if( threads <= 1 ) {
+            for( std::size_t i = begin; i < end; i++ )
+                f( i, 0u );
+            return;
+        }
+
+        std::atomic< std::size_t > next( begin );
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        auto work = [&]( unsigned worker ) {
+            try {
+                while( true ) {
+                    std::size_t first = next.fetch_add( chunk );
+                    if( first >= end )
+                        return;
+                    std::size_t last = first + chunk < end ? first + chunk : end;
+                    for( std::size_t i = first; i < last; i++ )
+                        f( i, worker );
+                }
+            }
+            catch( ... ) {
+                // Stop everyone else and remember the first failure.
+                next = end;
+                std::lock_guard< std::mutex > lock( error_mutex );
+                if( !error )
+                    error = std::current_exception();
+            }
+        };
+
+        std::vector< std::thread > pool;
+        for( unsigned worker = 1; worker < threads; worker++ )
+            pool.emplace_back( work, worker );
+        work( 0 );
+        for( auto & thread : pool )
+            thread.join();
+
+        if( error )
+            std::rethrow_exception( error );
+    }
+
+} // namespace parallel
+
+#endif // PARALLEL_PARALLEL_FOR_HPP
@@ -0,0 +1,456 @@
+#ifndef PINCH_BINARY_NOTICEBOARD_HPP
+#define PINCH_BINARY_NOTICEBOARD_HPP
+
+/* Binary, memory-mapped noticeboard format.
+ *
+ * The text format of pinch/noticeboard.hpp must be parsed entirely
+ * (converting every big integer from decimal) before a single group
+ * can be retrieved. In this format, every record has the same size,
+ * so a group is found by computing its position;
+ * the file is mapped with mmap, so a lookup only touches
+ * the pages that hold the header, the index and the group's record.
+ *
+ * Groups are not stored as ID lists. Instead, the header lists the
+ * sorted IDs of every user of the board, and each group is identified
+ * by its lexicographic rank (see math::combination) among the subsets
+ * of that ID list with size 'threshold'.
+ *
+ * File format (every integer is little-endian):
+ *  offset  size
+ *       0     8  magic "PINCHNB\0"
+ *       8     4  version (currently 1)
+ *      12     4  flags; bit 0 set means the ranks are contiguous
+ *      16     4  width: number of bytes of each big integer
+ *      20     4  users: number of user IDs
+ *      24     4  threshold: number of users in each group
+ *      28     4  reserved (zero)
+ *      32     8  count: number of groups
+ *      40     8  first_rank
+ *      48     w  generator
+ *     48+w    w  prime_modulo
+ *    48+2w  4*u  sorted user IDs, as signed 32-bit integers
+ * Then, unless the ranks are contiguous, the offset index:
+ *           8*c  the rank of each group, in increasing order.
+ * (If the ranks are contiguous, group i has rank first_rank + i.)
+ * Then, 'count' records of 2w bytes: group_generator and group_value.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <gmpxx.h>
+#include "math/set.hpp"
+#include "pinch/noticeboard.hpp"
+
+namespace pinch {
+namespace binary {
+
+    const char magic[8] = {'P', 'I', 'N', 'C', 'H', 'N', 'B', '\0'};
+    constexpr std::uint32_t version = 1;
+    constexpr std::uint32_t contiguous_ranks = 1;
+    constexpr std::size_t header_size = 48;
+
+    /* Little-endian encoding of fixed-size integers.
+     */
+    inline void put_le( unsigned char * buf, std::uint64_t value, int bytes ) {
+        for( int i = 0; i < bytes; i++ ) {
+            buf[i] = value & 0xff;
+            value >>= 8;
+        }
+    }
+
+    inline std::uint64_t get_le( const unsigned char * buf, int bytes ) {
+        std::uint64_t value = 0;
+        for( int i = bytes - 1; i >= 0; i-- )
+            value = value << 8 | buf[i];
+        return value;
+    }
+
+    /* Conversion between integers and fixed-width little-endian byte strings.
+     * Both mpz_class and the built-in integer types are supported.
+     * Only non-negative values are representable.
+     */
+    inline std::uint32_t byte_width( const mpz_class & n ) {
+        return (mpz_sizeinbase( n.get_mpz_t(), 2 ) + 7) / 8;
+    }
+
+    inline void write_integer( unsigned char * buf, const mpz_class & n, std::uint32_t width ) {
+        std::memset( buf, 0, width );
+        std::size_t count;
+        if( n != 0 )
+            mpz_export( buf, &count, -1, 1, 0, 0, n.get_mpz_t() );
+    }
+
+    inline void read_integer( const unsigned char * buf, mpz_class & n, std::uint32_t width ) {
+        mpz_import( n.get_mpz_t(), width, -1, 1, 0, 0, buf );
+    }
+
+    template< typename T >
+    typename std::enable_if< std::is_integral<T>::value, std::uint32_t >::type
+    byte_width( T n ) {
+        std::uint32_t width = 0;
+        for( std::uint64_t v = n; v != 0; v >>= 8 )
+            width++;
+        return width;
+    }
+
+    template< typename T >
+    typename std::enable_if< std::is_integral<T>::value >::type
+    write_integer( unsigned char * buf, T n, std::uint32_t width ) {
+        put_le( buf, n, width );
+    }
+
+    template< typename T >
+    typename std::enable_if< std::is_integral<T>::value >::type
+    read_integer( const unsigned char * buf, T & n, std::uint32_t width ) {
+        n = get_le( buf, width );
+    }
+
+    /* Header of a binary noticeboard, in memory.
+     */
+    template< typename T >
+    struct header {
+        std::uint32_t flags = 0;
+        std::uint32_t width;
+        std::uint32_t threshold;
+        std::uint64_t count;
+        std::uint64_t first_rank = 0;
+        T generator, prime_modulo;
+        std::vector<int> ids;
+    };
+
+    /* Writes the header, followed by the offset index if the ranks
+     * are not contiguous. The group records must be written afterwards,
+     * through write_record, in increasing order of rank.
+     *
+     * This way, a board can be written while it is being generated.
+     */
+    template< typename T >
+    void write_header(
+        std::ostream & os,
+        const header<T> & h,
+        const std::vector< std::uint64_t > & ranks = {}
+    );
+
+    /* Writes the record of a single group.
+     */
+    template< typename T >
+    void write_record( std::ostream & os, const group_data<T> & data, std::uint32_t width );
+
+    // Returns true if the given file starts with the binary noticeboard magic.
+    inline bool is_binary_noticeboard( const std::string & filename );
+
+} // namespace binary
+
+    /* Writes the given board in binary format.
+     *
+     * Every group of the board must have the same size.
+     * The groups need not be sorted, and the board need not be complete
+     * (it may lack some subsets of the users).
+     */
+    template< typename T >
+    void write_binary_noticeboard( std::ostream & os, const noticeboard<T> & board );
+
+    /* Read-only view of a binary noticeboard file, mapped in memory.
+     *
+     * Opening the board only reads its header;
+     * each call to retrieve_data decodes a single record.
+     */
+    template< typename T >
+    class mapped_noticeboard {
+        const unsigned char * data = nullptr;
+        std::size_t map_size = 0;
+        binary::header<T> h;
+        const unsigned char * ranks = nullptr;   // Offset index
+        const unsigned char * records = nullptr;
+
+        std::uint64_t rank_at( std::uint64_t i ) const {
+            return binary::get_le( ranks + 8*i, 8 );
+        }
+
+    public:
+        T generator, prime_modulo; // Parameters for the function f
+
+        /* Maps the given file.
+         * Throws std::runtime_error if the file cannot be mapped
+         * or is not a valid binary noticeboard.
+         */
+        explicit mapped_noticeboard( const std::string & filename );
+        ~mapped_noticeboard();
+
+        mapped_noticeboard( const mapped_noticeboard & ) = delete;
+        mapped_noticeboard & operator=( const mapped_noticeboard & ) = delete;
+
+        // Number of groups in the board.
+        std::uint64_t size() const { return h.count; }
+
+        // Sorted list of the users of this board.
+        const std::vector<int> & users() const { return h.ids; }
+
+        // Number of users in each group.
+        int threshold() const { return h.threshold; }
+
+        // Rank of the first group of the board.
+        std::uint64_t first_rank() const { return h.first_rank; }
+
+        /* Returns the lexicographic rank of the given group
+         * among the subsets of users() with size threshold().
+         * Throws std::out_of_range if the group is not such a subset.
+         * The group need not be in this board.
+         */
+        std::uint64_t rank_of( const std::vector<int> & group ) const;
+
+        /* Retrieves the group_data corresponding to the given group,
+         * which must be sorted.
+         * Throws std::out_of_range if the group is not in the board.
+         */
+        group_data<T> retrieve_data( const std::vector<int> & group ) const;
+
+        /* Retrieves the i-th group of the board, in increasing order of rank.
+         */
+        group_data<T> group_at( std::uint64_t i ) const;
+
+        // Converts the whole board to the in-memory representation.
+        noticeboard<T> load() const;
+    };
+
+// Implementation
+
+namespace binary {
+
+    template< typename T >
+    void write_header(
+        std::ostream & os,
+        const header<T> & h,
+        const std::vector< std::uint64_t > & ranks
+    ) {
+        std::vector< unsigned char > buf( header_size + 2 * h.width + 4 * h.ids.size() );
+        std::memcpy( buf.data(), magic, 8 );
+        put_le( &buf[8], version, 4 );
+        put_le( &buf[12], h.flags, 4 );
+        put_le( &buf[16], h.width, 4 );
+        put_le( &buf[20], h.ids.size(), 4 );
+        put_le( &buf[24], h.threshold, 4 );
+        put_le( &buf[28], 0, 4 );
+        put_le( &buf[32], h.count, 8 );
+        put_le( &buf[40], h.first_rank, 8 );
+        write_integer( &buf[header_size], h.generator, h.width );
+        write_integer( &buf[header_size + h.width], h.prime_modulo, h.width );
+        for( std::size_t i = 0; i < h.ids.size(); i++ )
+            put_le( &buf[header_size + 2*h.width + 4*i], (std::uint32_t) h.ids[i], 4 );
+        os.write( (const char *) buf.data(), buf.size() );
+
+        if( !(h.flags & contiguous_ranks) ) {
+            unsigned char rank[8];
+            for( std::uint64_t r : ranks ) {
+                put_le( rank, r, 8 );
+                os.write( (const char *) rank, 8 );
+            }
+        }
+    }
+
+    template< typename T >
+    void write_record( std::ostream & os, const group_data<T> & data, std::uint32_t width ) {
+        std::vector< unsigned char > buf( 2 * width );
+        write_integer( buf.data(), data.group_generator, width );
+        write_integer( buf.data() + width, data.group_value, width );
+        os.write( (const char *) buf.data(), buf.size() );
+    }
+
+    inline bool is_binary_noticeboard( const std::string & filename ) {
+        std::ifstream file( filename, std::ios::binary );
+        char buf[8];
+        return file.read( buf, 8 ) && std::memcmp( buf, magic, 8 ) == 0;
+    }
+
+} // namespace binary
+
+    template< typename T >
+    void write_binary_noticeboard( std::ostream & os, const noticeboard<T> & board ) {
+        binary::header<T> h;
+        h.generator = board.generator;
+        h.prime_modulo = board.prime_modulo;
+        h.width = binary::byte_width( board.prime_modulo );
+        h.threshold = board.groups.empty() ? 0 : board.groups[0].group.size();
+        h.count = board.groups.size();
+
+        for( const auto & data : board.groups ) {
+            if( data.group.size() != h.threshold )
+                throw std::invalid_argument( "Every group must have the same size." );
+            h.ids.insert( h.ids.end(), data.group.begin(), data.group.end() );
+        }
+        std::sort( h.ids.begin(), h.ids.end() );
+        h.ids.erase( std::unique( h.ids.begin(), h.ids.end() ), h.ids.end() );
+
+        // Pair each group with its rank and sort the groups by it.
+        std::vector< std::pair< std::uint64_t, std::size_t > > order;
+        std::vector<int> positions( h.threshold );
+        for( std::size_t i = 0; i < board.groups.size(); i++ ) {
+            std::vector<int> group = board.groups[i].group;
+            std::sort( group.begin(), group.end() );
+            for( std::uint32_t j = 0; j < h.threshold; j++ )
+                positions[j] = std::lower_bound( h.ids.begin(), h.ids.end(), group[j] )
+                    - h.ids.begin();
+            order.emplace_back( math::combination::rank_of( h.ids.size(), positions ), i );
+        }
+        std::sort( order.begin(), order.end() );
+
+        std::vector< std::uint64_t > ranks;
+        for( const auto & pair : order )
+            ranks.push_back( pair.first );
+        if( !ranks.empty() && ranks.back() - ranks.front() + 1 == ranks.size() ) {
+            h.flags |= binary::contiguous_ranks;
+            h.first_rank = ranks.front();
+        }
+
+        binary::write_header( os, h, ranks );
+        for( const auto & pair : order )
+            binary::write_record( os, board.groups[pair.second], h.width );
+    }
+
+    template< typename T >
+    mapped_noticeboard<T>::mapped_noticeboard( const std::string & filename ) {
+        int fd = open( filename.c_str(), O_RDONLY );
+        if( fd < 0 )
+            throw std::runtime_error( "Could not open " + filename );
+        struct stat st;
+        if( fstat( fd, &st ) != 0 || st.st_size < (off_t) binary::header_size ) {
+            close( fd );
+            throw std::runtime_error( filename + " is not a binary noticeboard." );
+        }
+        map_size = st.st_size;
+        void * map = mmap( nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0 );
+        close( fd );
+        if( map == MAP_FAILED )
+            throw std::runtime_error( "Could not map " + filename );
+        data = (const unsigned char *) map;
+
+        auto fail = [&]( const char * what ) {
+            munmap( (void *) data, map_size );
+            throw std::runtime_error( filename + ": " + what );
+        };
+
+        if( std::memcmp( data, binary::magic, 8 ) != 0 )
+            fail( "not a binary noticeboard." );
+        if( binary::get_le( data + 8, 4 ) != binary::version )
+            fail( "unsupported binary noticeboard version." );
+
+        h.flags = binary::get_le( data + 12, 4 );
+        h.width = binary::get_le( data + 16, 4 );
+        std::uint64_t users = binary::get_le( data + 20, 4 );
+        h.threshold = binary::get_le( data + 24, 4 );
+        h.count = binary::get_le( data + 32, 8 );
+        h.first_rank = binary::get_le( data + 40, 8 );
+
+        std::uint64_t index_size = h.flags & binary::contiguous_ranks ? 0 : 8 * h.count;
+        std::uint64_t expected = binary::header_size + 2 * h.width + 4 * users
+            + index_size + 2 * h.width * h.count;
+        if( expected != map_size )
+            fail( "truncated or corrupted binary noticeboard." );
+
+        binary::read_integer( data + binary::header_size, h.generator, h.width );
+        binary::read_integer( data + binary::header_size + h.width, h.prime_modulo, h.width );
+        const unsigned char * ids = data + binary::header_size + 2 * h.width;
+        for( std::uint64_t i = 0; i < users; i++ )
+            h.ids.push_back( (std::int32_t) binary::get_le( ids + 4*i, 4 ) );
+        ranks = ids + 4 * users;
+        records = ranks + index_size;
+
+        generator = h.generator;
+        prime_modulo = h.prime_modulo;
+    }
+
+    template< typename T >
+    mapped_noticeboard<T>::~mapped_noticeboard() {
+        if( data )
+            munmap( (void *) data, map_size );
+    }
+
+    template< typename T >
+    group_data<T> mapped_noticeboard<T>::group_at( std::uint64_t i ) const {
+        group_data<T> ret;
+        const unsigned char * record = records + 2 * h.width * i;
+        binary::read_integer( record, ret.group_generator, h.width );
+        binary::read_integer( record + h.width, ret.group_value, h.width );
+
+        std::uint64_t rank = h.flags & binary::contiguous_ranks ? h.first_rank + i : rank_at( i );
+        math::combination c( h.ids.size(), h.threshold, rank );
+        for( int index : c.indexes() )
+            ret.group.push_back( h.ids[index] );
+        return ret;
+    }
+
+    template< typename T >
+    std::uint64_t mapped_noticeboard<T>::rank_of( const std::vector<int> & group ) const {
+        auto not_found = std::out_of_range( "Specified group not in the noticeboard." );
+        if( group.size() != h.threshold || h.ids.size() < h.threshold )
+            throw not_found;
+
+        std::vector<int> positions( group.size() );
+        for( std::size_t j = 0; j < group.size(); j++ ) {
+            auto it = std::lower_bound( h.ids.begin(), h.ids.end(), group[j] );
+            if( it == h.ids.end() || *it != group[j] || (j > 0 && group[j] <= group[j-1]) )
+                throw not_found;
+            positions[j] = it - h.ids.begin();
+        }
+        return math::combination::rank_of( h.ids.size(), positions );
+    }
+
+    template< typename T >
+    group_data<T> mapped_noticeboard<T>::retrieve_data( const std::vector<int> & group ) const {
+        auto not_found = std::out_of_range( "Specified group not in the noticeboard." );
+        std::uint64_t rank = rank_of( group );
+
+        std::uint64_t i;
+        if( h.flags & binary::contiguous_ranks ) {
+            if( rank < h.first_rank || rank - h.first_rank >= h.count )
+                throw not_found;
+            i = rank - h.first_rank;
+        }
+        else {
+            // Binary search in the offset index.
+            std::uint64_t low = 0, high = h.count;
+            while( low < high ) {
+                std::uint64_t mid = low + (high - low) / 2;
+                if( rank_at( mid ) < rank )
+                    low = mid + 1;
+                else
+                    high = mid;
+            }
+            if( low == h.count || rank_at( low ) != rank )
+                throw not_found;
+            i = low;
+        }
+
+        group_data<T> ret;
+        const unsigned char * record = records + 2 * h.width * i;
+        binary::read_integer( record, ret.group_generator, h.width );
+        binary::read_integer( record + h.width, ret.group_value, h.width );
+        ret.group = group;
+        return ret;
+    }
+
+    template< typename T >
+    noticeboard<T> mapped_noticeboard<T>::load() const {
+        noticeboard<T> board;
+        board.generator = generator;
+        board.prime_modulo = prime_modulo;
+        for( std::uint64_t i = 0; i < h.count; i++ )
+            board.groups.push_back( group_at( i ) );
+        board.build_index();
+        return board;
+    }
+
+} // namespace pinch
+
+#endif // PINCH_BINARY_NOTICEBOARD_HPP
@@ -0,0 +1,303 @@
+#ifndef PINCH_DEALER_DATABASE_HPP
+#define PINCH_DEALER_DATABASE_HPP
+
+/* Binary, indexed format for the dealer's share database.
+ *
+ * The text format of pinch/dealer_information.hpp must be read
+ * and rewritten entirely whenever a single share is added or removed.
+ * In this format, every share is a fixed-size record, and the records
+ * are sorted by ID (the IDs are handed out in increasing order),
+ * so the database is updated in place:
+ * new shares are appended to the end of the file,
+ * and a share is removed by finding its record through binary search
+ * and setting a tombstone flag in it.
+ * Neither operation reads or writes the other records.
+ *
+ * File format (every integer is little-endian):
+ *  offset  size
+ *       0     8  magic "PINCHDB\0"
+ *       8     4  version (currently 1)
+ *      12     4  width: number of bytes of each big integer
+ *      16     4  last_id
+ *      20     4  reserved (zero)
+ *      24     w  prime
+ *     24+w    w  generator
+ * Then, one record of 8+w bytes for each share ever issued,
+ * in increasing order of ID:
+ *       0     4  id, as a signed 32-bit integer
+ *       4     4  flags; bit 0 set means the share was removed
+ *       8     w  share
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "pinch/binary_noticeboard.hpp"
+#include "pinch/dealer_information.hpp"
+#include "pinch/shares.hpp"
+
+namespace pinch {
+namespace binary {
+
+    const char database_magic[8] = {'P', 'I', 'N', 'C', 'H', 'D', 'B', '\0'};
+    constexpr std::uint32_t database_version = 1;
+    constexpr std::uint32_t removed_share = 1;
+    constexpr std::size_t database_header_size = 24;
+
+    // Returns true if the given file starts with the dealer database magic.
+    inline bool is_dealer_database( const std::string & filename );
+
+} // namespace binary
+
+    /* Binary dealer database, opened for reading and updating.
+     */
+    template< typename T >
+    class dealer_database {
+        int fd = -1;
+        std::string filename;
+        std::uint32_t width;
+        std::uint64_t records;
+        T prime, generator;
+        int last_id;
+
+        std::size_t record_size() const { return 8 + width; }
+        std::uint64_t record_offset( std::uint64_t i ) const {
+            return binary::database_header_size + 2 * width + i * record_size();
+        }
+        void read_at( std::uint64_t offset, unsigned char * buf, std::size_t size ) const;
+        void write_at( std::uint64_t offset, const unsigned char * buf, std::size_t size );
+
+    public:
+        /* Opens the given database.
+         * Throws std::runtime_error if it is not a valid dealer database.
+         */
+        explicit dealer_database( const std::string & filename );
+        ~dealer_database();
+
+        dealer_database( const dealer_database & ) = delete;
+        dealer_database & operator=( const dealer_database & ) = delete;
+
+        /* Writes the given shares to a new database file,
+         * replacing the file if it exists.
+         * The shares must be sorted by ID.
+         */
+        static void create( const std::string & filename, const dealer_information<T> & );
+
+        /* Returns a dealer_information with the prime, the generator
+         * and the last ID of this database, but no shares.
+         * This is enough to generate new shares.
+         */
+        dealer_information<T> header() const;
+
+        // Reads every share that was not removed.
+        dealer_information<T> load() const;
+
+        /* Appends the given shares to the database.
+         * Their IDs must be greater than the IDs already in the database,
+         * and increasing; otherwise, std::invalid_argument is thrown.
+         */
+        void append( const std::vector< share<T> > & shares );
+
+        /* Marks the share with the given ID as removed.
+         * Only O(log n) records are read.
+         * Returns true if something was removed, and false otherwise.
+         */
+        bool remove( int id );
+
+        // Number of records, including the removed shares.
+        std::uint64_t size() const { return records; }
+    };
+
+// Implementation
+
+namespace binary {
+
+    bool is_dealer_database( const std::string & filename ) {
+        std::ifstream file( filename, std::ios::binary );
+        char buf[8];
+        return file.read( buf, 8 ) && std::memcmp( buf, database_magic, 8 ) == 0;
+    }
+
+} // namespace binary
+
+    template< typename T >
+    dealer_database<T>::dealer_database( const std::string & filename ) :
+        filename( filename )
+    {
+        fd = open( filename.c_str(), O_RDWR );
+        if( fd < 0 )
+            throw std::runtime_error( "Could not open " + filename );
+
+        auto fail = [&]( const char * what ) {
+            close( fd );
+            fd = -1;
+            throw std::runtime_error( filename + ": " + what );
+        };
+
+        struct stat st;
+        unsigned char buf[binary::database_header_size];
+        if( fstat( fd, &st ) != 0 || st.st_size < (off_t) binary::database_header_size
+                || pread( fd, buf, sizeof buf, 0 ) != (ssize_t) sizeof buf
+                || std::memcmp( buf, binary::database_magic, 8 ) != 0 )
+            fail( "not a dealer database." );
+        if( binary::get_le( buf + 8, 4 ) != binary::database_version )
+            fail( "unsupported dealer database version." );
+        width = binary::get_le( buf + 12, 4 );
+        last_id = (std::int32_t) binary::get_le( buf + 16, 4 );
+
+        std::uint64_t data = st.st_size - binary::database_header_size;
+        if( data < 2 * width || (data - 2 * width) % record_size() != 0 )
+            fail( "truncated or corrupted dealer database." );
+        records = (data - 2 * width) / record_size();
+
+        std::vector< unsigned char > numbers( 2 * width );
+        read_at( binary::database_header_size, numbers.data(), numbers.size() );
+        binary::read_integer( numbers.data(), prime, width );
+        binary::read_integer( numbers.data() + width, generator, width );
+    }
+
+    template< typename T >
+    dealer_database<T>::~dealer_database() {
+        if( fd >= 0 )
+            close( fd );
+    }
+
+    template< typename T >
+    void dealer_database<T>::read_at(
+        std::uint64_t offset,
+        unsigned char * buf,
+        std::size_t size
+    ) const {
+        if( pread( fd, buf, size, offset ) != (ssize_t) size )
+            throw std::runtime_error( "Could not read " + filename );
+    }
+
+    template< typename T >
+    void dealer_database<T>::write_at(
+        std::uint64_t offset,
+        const unsigned char * buf,
+        std::size_t size
+    ) {
+        if( pwrite( fd, buf, size, offset ) != (ssize_t) size )
+            throw std::runtime_error( "Could not write " + filename );
+    }
+
+    template< typename T >
+    void dealer_database<T>::create(
+        const std::string & filename,
+        const dealer_information<T> & info
+    ) {
+        std::uint32_t width = binary::byte_width( info.prime );
+        std::vector< unsigned char > buf( binary::database_header_size + 2 * width );
+        std::memcpy( buf.data(), binary::database_magic, 8 );
+        binary::put_le( &buf[8], binary::database_version, 4 );
+        binary::put_le( &buf[12], width, 4 );
+        binary::put_le( &buf[16], (std::uint32_t) info.last_id, 4 );
+        binary::put_le( &buf[20], 0, 4 );
+        binary::write_integer( &buf[binary::database_header_size], info.prime, width );
+        binary::write_integer( &buf[binary::database_header_size + width],
+            info.generator, width );
+
+        std::ofstream file( filename, std::ios::binary | std::ios::trunc );
+        file.write( (const char *) buf.data(), buf.size() );
+        file.close();
+        if( !file )
+            throw std::runtime_error( "Could not write " + filename );
+
+        dealer_database<T> db( filename );
+        db.append( info.valid_shares );
+    }
+
+    template< typename T >
+    dealer_information<T> dealer_database<T>::header() const {
+        dealer_information<T> info;
+        info.prime = prime;
+        info.generator = generator;
+        info.last_id = last_id;
+        return info;
+    }
+
+    template< typename T >
+    dealer_information<T> dealer_database<T>::load() const {
+        dealer_information<T> info = header();
+        std::vector< unsigned char > buf( records * record_size() );
+        read_at( record_offset( 0 ), buf.data(), buf.size() );
+        for( std::uint64_t i = 0; i < records; i++ ) {
+            const unsigned char * record = &buf[i * record_size()];
+            if( binary::get_le( record + 4, 4 ) & binary::removed_share )
+                continue;
+            share<T> s;
+            s.id = (std::int32_t) binary::get_le( record, 4 );
+            binary::read_integer( record + 8, s.share, width );
+            info.valid_shares.push_back( s );
+        }
+        return info;
+    }
+
+    template< typename T >
+    void dealer_database<T>::append( const std::vector< share<T> > & shares ) {
+        if( shares.empty() )
+            return;
+        int previous = 0; // Greatest ID in the file
+        if( records > 0 ) {
+            unsigned char id[4];
+            read_at( record_offset( records - 1 ), id, 4 );
+            previous = (std::int32_t) binary::get_le( id, 4 );
+        }
+
+        std::vector< unsigned char > buf( shares.size() * record_size() );
+        for( std::size_t i = 0; i < shares.size(); i++ ) {
+            if( shares[i].id <= previous )
+                throw std::invalid_argument( "Shares must be appended in increasing order of ID." );
+            previous = shares[i].id;
+            unsigned char * record = &buf[i * record_size()];
+            binary::put_le( record, (std::uint32_t) shares[i].id, 4 );
+            binary::put_le( record + 4, 0, 4 );
+            binary::write_integer( record + 8, shares[i].share, width );
+        }
+
+        // The records are written before last_id, so that it never points past them.
+        write_at( record_offset( records ), buf.data(), buf.size() );
+        records += shares.size();
+        if( previous > last_id ) {
+            last_id = previous;
+            unsigned char id[4];
+            binary::put_le( id, (std::uint32_t) last_id, 4 );
+            write_at( 16, id, 4 );
+        }
+    }
+
+    template< typename T >
+    bool dealer_database<T>::remove( int id ) {
+        // Binary search over the record IDs.
+        std::uint64_t low = 0, high = records;
+        unsigned char buf[8];
+        while( low < high ) {
+            std::uint64_t mid = low + (high - low) / 2;
+            read_at( record_offset( mid ), buf, 4 );
+            if( (std::int32_t) binary::get_le( buf, 4 ) < id )
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        if( low == records )
+            return false;
+        read_at( record_offset( low ), buf, 8 );
+        std::uint32_t flags = binary::get_le( buf + 4, 4 );
+        if( (std::int32_t) binary::get_le( buf, 4 ) != id || (flags & binary::removed_share) )
+            return false;
+
+        binary::put_le( buf + 4, flags | binary::removed_share, 4 );
+        write_at( record_offset( low ) + 4, buf + 4, 4 );
+        return true;
+    }
+
+} // namespace pinch
+
+#endif // PINCH_DEALER_DATABASE_HPP
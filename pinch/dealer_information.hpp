@@ -11,16 +11,57 @@
  * separated by newline.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
 #include <vector>
+#include "instrument/instrument.hpp"
+#include "math/exponent_ring.hpp"
 #include "math/primitive_root.hpp"
 #include "math/set.hpp"
+#include "parallel/parallel_for.hpp"
 #include "random/gmp_adapter.hpp"
+#include "random/xorshift.hpp"
+#include "pinch/binary_noticeboard.hpp"
 #include "pinch/noticeboard.hpp"
 #include "pinch/shares.hpp"
 
 namespace pinch {
 
+    /* Progress report of a noticeboard generation.
+     * A line with the number of groups generated so far
+     * and the throughput is written to the stream every interval groups,
+     * and when the last group is generated.
+     * Thread-safe.
+     */
+    struct generation_progress {
+        std::ostream * os;
+        std::size_t interval;
+        std::uint64_t total;
+        std::atomic< std::uint64_t > done{ 0 };
+        std::mutex mutex;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        generation_progress( std::ostream * os, std::size_t interval, std::uint64_t total ) :
+            os( os ), interval( interval ), total( total )
+        {}
+
+        // Registers that one more group was generated.
+        void tick() {
+            std::uint64_t count = ++done;
+            if( os && (count % interval == 0 || count == total) ) {
+                double seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start ).count();
+                std::lock_guard< std::mutex > lock( mutex );
+                *os << count << '/' << total << " groups, "
+                    << count / seconds << " groups/s\n";
+            }
+        }
+    };
+
     template< typename T >
     struct dealer_information {
         std::vector< share<T> > valid_shares;
@@ -28,11 +69,28 @@ namespace pinch {
         T prime;
         T generator;
 
+        /* Optional math::fixed_base table for generator modulo prime,
+         * used for the exponentiations with the generator as base
+         * (the one-way function f and the group generators).
+         * It is not part of the file format;
+         * if it is empty or does not match generator and prime,
+         * each noticeboard generation builds its own table.
+         */
+        math::fixed_base<T> generator_table;
+
         /* Generates a new share for the list.
          */
         template< typename RNG >
         share<T> new_share( RNG & );
 
+        /* Generates count new shares, with consecutive IDs,
+         * and returns them; they are also added to the list.
+         * The share values are drawn in parallel, using the given number
+         * of threads, each with its own xorshift generator seeded by rng.
+         */
+        template< typename RNG >
+        std::vector< share<T> > issue_shares( std::size_t count, RNG & rng, unsigned threads = 1 );
+
         /* Remove the share with the specified identifier.
          * To ensure that the specified user is not able to access the secret,
          * the noticeboard must be regenerated with another secret
@@ -47,10 +105,137 @@ namespace pinch {
          * will be able to reconstruct the given secret
          * using the information in the noticeboard.
          *
-         * The RNG will be used to create the generators.
+         * The groups are spread over the given number of threads.
+         * The RNG will be used to seed one xorshift generator per thread,
+         * which in turn create the group generators.
+         * Regardless of the number of threads,
+         * the groups appear in the board in sorted order.
+         *
+         * If progress is not null, a line reporting the number of groups
+         * generated so far and the throughput is written there
+         * every progress_interval groups.
+         */
+        template< typename RNG >
+        noticeboard<T> generate_noticeboard(
+            T secret,
+            int threshold,
+            RNG & rng,
+            unsigned threads = 1,
+            std::ostream * progress = nullptr,
+            std::size_t progress_interval = 10000
+        ) const;
+
+        /* Checks that the board can be extended with the given secret
+         * and threshold: its first group must have threshold members,
+         * all of them valid shares, and reconstruct the secret.
+         * Throws std::invalid_argument otherwise.
+         * An empty board passes any check.
+         */
+        void check_noticeboard( const noticeboard<T> & board, T secret, int threshold ) const;
+
+        /* Adds to the board the groups that include at least one
+         * of the shares with the given IDs, which must be valid shares
+         * that are not yet in the board.
+         * For a single new share, these are the C(n-1, threshold-1) groups
+         * that contain it, instead of the C(n, threshold) of a full rebuild.
+         *
+         * The board is first checked with check_noticeboard.
+         *
+         * Returns the number of groups added.
+         */
+        template< typename RNG >
+        std::size_t extend_noticeboard(
+            noticeboard<T> & board,
+            T secret,
+            int threshold,
+            const std::vector<int> & new_ids,
+            RNG & rng,
+            unsigned threads = 1
+        ) const;
+
+        /* Removes from the board every group that contains the given ID.
+         * The remaining members of those groups can still reconstruct
+         * the secret through other groups.
+         *
+         * Note that the removed user still knows the secret,
+         * so this is only appropriate if it needs not be changed;
+         * otherwise, generate a new noticeboard with another secret.
+         *
+         * Returns the number of groups removed.
+         */
+        static std::size_t prune_noticeboard( noticeboard<T> & board, int id );
+
+        /* Generates the groups of the noticeboard with ranks
+         * first_rank, ..., first_rank + count - 1 (see math::combination)
+         * and writes them to os as a binary noticeboard with contiguous ranks
+         * (see pinch/binary_noticeboard.hpp).
+         * This is one shard of a sharded noticeboard
+         * (see pinch/sharded_noticeboard.hpp).
+         *
+         * The groups are generated in batches of batch_size groups,
+         * each batch written before the next one is generated,
+         * so the memory used does not depend on count.
+         * threads, progress and progress_interval work as in
+         * generate_noticeboard.
+         */
+        template< typename RNG >
+        void write_noticeboard_shard(
+            std::ostream & os,
+            T secret,
+            int threshold,
+            std::uint64_t first_rank,
+            std::uint64_t count,
+            RNG & rng,
+            unsigned threads = 1,
+            std::ostream * progress = nullptr,
+            std::size_t progress_interval = 10000,
+            std::size_t batch_size = 1 << 14
+        ) const;
+
+        /* Fills groups[0], ..., groups[count-1] with the groups of ranks
+         * first_rank, ..., first_rank + count - 1,
+         * using one thread for each stream.
+         * There must be a combination cursor for each stream;
+         * the cursors are reused between calls.
+         */
+        void fill_ranks(
+            group_data<T> * groups,
+            std::uint64_t first_rank,
+            std::uint64_t count,
+            const T & secret,
+            const math::fixed_base<T> & f,
+            std::vector< rng::xorshift > & streams,
+            std::vector< math::combination > & cursors,
+            generation_progress & progress
+        ) const;
+
+        /* Fills the given group_data with the group made of the shares
+         * in the given positions of valid_shares.
+         * This is the work done for each group of the noticeboard.
          */
         template< typename RNG >
-        noticeboard<T> generate_noticeboard( T secret, int threshold, RNG & rng ) const;
+        void fill_group(
+            group_data<T> & data,
+            const std::vector<int> & indexes,
+            const T & secret,
+            const math::fixed_base<T> & f,
+            RNG & rng
+        ) const;
+
+        /* Returns generator_table if it matches generator and prime;
+         * otherwise, builds a new table in scratch and returns it.
+         */
+        const math::fixed_base<T> & generator_powers( math::fixed_base<T> & scratch ) const;
+
+        /* Returns the position of the share with the given ID
+         * in valid_shares, or -1 if there is no such share.
+         */
+        int share_index( int id ) const;
+
+        /* Draws a random share value, less than prime.
+         */
+        template< typename RNG >
+        T random_share( RNG & ) const;
 
     };
 
@@ -75,22 +260,53 @@ namespace pinch {
     template< typename T >
     template< typename RNG >
     share<T> dealer_information<T>::new_share( RNG & rng ) {
+        share<T> new_share{++last_id, random_share( rng )};
+        valid_shares.push_back( new_share );
+        return new_share;
+    }
+
+    template< typename T >
+    template< typename RNG >
+    std::vector< share<T> > dealer_information<T>::issue_shares(
+        std::size_t count,
+        RNG & rng,
+        unsigned threads
+    ) {
+        if( threads == 0 )
+            threads = 1;
+        std::vector< rng::xorshift > streams;
+        for( unsigned i = 0; i < threads; i++ )
+            streams.emplace_back( rng(), rng(), rng(), rng() );
+
+        std::vector< share<T> > issued( count );
+        parallel::parallel_for( 0, count, threads,
+            [&]( std::size_t i, unsigned worker ) {
+                issued[i].id = last_id + 1 + i;
+                issued[i].share = random_share( streams[worker] );
+            },
+            256
+        );
+        last_id += count;
+        valid_shares.insert( valid_shares.end(), issued.begin(), issued.end() );
+        return issued;
+    }
+
+    template< typename T >
+    template< typename RNG >
+    T dealer_information<T>::random_share( RNG & rng ) const {
         // TODO: Make this GMP-independent
         int bits = mpz_sizeinbase( prime.get_mpz_t(), 2 );
         auto number = rng::gmp_generate( rng, bits );
-        share<T> new_share{++last_id, T(number % prime)};
-        valid_shares.push_back( new_share );
-        return new_share;
+        return T(number % prime);
     }
 
     template< typename T >
     bool dealer_information<T>::remove_share( int id ) {
-        for( int i = 0; i < valid_shares.size(); i++ )
-            if( valid_shares[i].id == id ) {
-                valid_shares.erase( valid_shares.begin() + i );
-                return true;
-            }
-        return false;
+        int index = share_index( id );
+        if( index < 0 )
+            return false;
+        valid_shares.erase( valid_shares.begin() + index );
+        return true;
     }
 
     template< typename T >
@@ -98,35 +314,279 @@ namespace pinch {
     noticeboard<T> dealer_information<T>::generate_noticeboard(
         T secret,
         int threshold,
-        RNG & rng
+        RNG & rng,
+        unsigned threads,
+        std::ostream * progress,
+        std::size_t progress_interval
     ) const {
+        instrument::scoped_timer timer( instrument::timer::generate_noticeboard );
         noticeboard<T> board;
         board.generator = generator;
         board.prime_modulo = prime;
 
-        std::vector<int> indexes;
-        for( int i = 0; i < valid_shares.size(); i++ )
-            indexes.push_back( i );
+        int users = valid_shares.size();
+        std::size_t total = math::binomial( users, threshold );
+        board.groups.resize( total );
 
-        for( auto group_indexes: math::sorted_subsets( indexes, threshold ) ) {
-            group_data<T> data;
-            data.group_generator =
-                math::random_primitive_root_modulo_p( prime, generator, rng );
+        if( threads == 0 )
+            threads = 1;
+        std::vector< rng::xorshift > streams;
+        std::vector< math::combination > cursors;
+        for( unsigned i = 0; i < threads; i++ ) {
+            streams.emplace_back( rng(), rng(), rng(), rng() );
+            cursors.emplace_back( users, threshold );
+        }
 
-            T power = 1; // Power that g_X must be raised to compute V_X.
-            for( auto index : group_indexes ) {
-                power *= valid_shares[index].share;
-                data.group.push_back( valid_shares[index].id );
-            }
+        math::fixed_base<T> scratch;
+        const auto & f = generator_powers( scratch );
+        generation_progress meter( progress, progress_interval, total );
+        fill_ranks( board.groups.data(), 0, total, secret, f, streams, cursors, meter );
+
+        board.build_index();
+        return board;
+    }
+
+    template< typename T >
+    template< typename RNG >
+    void dealer_information<T>::write_noticeboard_shard(
+        std::ostream & os,
+        T secret,
+        int threshold,
+        std::uint64_t first_rank,
+        std::uint64_t count,
+        RNG & rng,
+        unsigned threads,
+        std::ostream * progress,
+        std::size_t progress_interval,
+        std::size_t batch_size
+    ) const {
+        int users = valid_shares.size();
+        if( first_rank + count > math::binomial( users, threshold ) )
+            throw std::out_of_range( "The shard exceeds the number of groups." );
 
-            T V_X = math::pow_mod( data.group_generator, power, prime );
-            T f_V_X = math::pow_mod( generator, V_X, prime );
-            data.group_value = (secret - f_V_X + prime) % prime;
+        binary::header<T> h;
+        h.flags = binary::contiguous_ranks;
+        h.width = binary::byte_width( prime );
+        h.threshold = threshold;
+        h.count = count;
+        h.first_rank = first_rank;
+        h.generator = generator;
+        h.prime_modulo = prime;
+        for( const auto & share : valid_shares )
+            h.ids.push_back( share.id ); // valid_shares is sorted by ID
+        binary::write_header( os, h );
 
-            board.groups.push_back( data );
+        if( threads == 0 )
+            threads = 1;
+        std::vector< rng::xorshift > streams;
+        std::vector< math::combination > cursors;
+        for( unsigned i = 0; i < threads; i++ ) {
+            streams.emplace_back( rng(), rng(), rng(), rng() );
+            cursors.emplace_back( users, threshold );
         }
 
-        return board;
+        math::fixed_base<T> scratch;
+        const auto & f = generator_powers( scratch );
+        generation_progress meter( progress, progress_interval, count );
+        std::vector< group_data<T> > batch( std::min< std::uint64_t >( batch_size, count ) );
+        for( std::uint64_t done = 0; done < count; done += batch.size() ) {
+            std::size_t size = std::min< std::uint64_t >( batch.size(), count - done );
+            fill_ranks( batch.data(), first_rank + done, size, secret, f,
+                streams, cursors, meter );
+            for( std::size_t i = 0; i < size; i++ )
+                binary::write_record( os, batch[i], h.width );
+        }
+    }
+
+    template< typename T >
+    void dealer_information<T>::fill_ranks(
+        group_data<T> * groups,
+        std::uint64_t first_rank,
+        std::uint64_t count,
+        const T & secret,
+        const math::fixed_base<T> & f,
+        std::vector< rng::xorshift > & streams,
+        std::vector< math::combination > & cursors,
+        generation_progress & progress
+    ) const {
+        /* Group number i is made of the shares in the combination of rank i,
+         * so the groups are enumerated in sorted order without being stored.
+         * Each thread keeps its own combination iterator,
+         * that is advanced if the thread got the next group
+         * and unranked otherwise.
+         */
+        parallel::parallel_for( 0, count, streams.size(),
+            [&]( std::size_t k, unsigned worker ) {
+                std::uint64_t i = first_rank + k;
+                math::combination & group_indexes = cursors[worker];
+                if( group_indexes.rank() + 1 == i )
+                    group_indexes.next();
+                else if( group_indexes.rank() != i )
+                    group_indexes.unrank( i );
+
+                fill_group( groups[k], group_indexes.indexes(), secret, f, streams[worker] );
+                progress.tick();
+            },
+            64
+        );
+    }
+
+    template< typename T >
+    template< typename RNG >
+    void dealer_information<T>::fill_group(
+        group_data<T> & data,
+        const std::vector<int> & indexes,
+        const T & secret,
+        const math::fixed_base<T> & f,
+        RNG & rng
+    ) const {
+        instrument::count( instrument::counter::noticeboard_groups );
+        data.group_generator = math::random_primitive_root_modulo_p( f, rng );
+
+        // Power that g_X must be raised to compute V_X, reduced modulo the group order.
+        math::exponent_ring<T> exponents( prime - 1 );
+        T power = 1;
+        data.group.clear();
+        for( auto index : indexes ) {
+            power = exponents.multiply( power, valid_shares[index].share );
+            data.group.push_back( valid_shares[index].id );
+        }
+
+        T V_X = math::pow_mod( data.group_generator, power, prime );
+        T f_V_X = f.pow( V_X );
+        data.group_value = (secret - f_V_X + prime) % prime;
+    }
+
+    template< typename T >
+    const math::fixed_base<T> & dealer_information<T>::generator_powers(
+        math::fixed_base<T> & scratch
+    ) const {
+        if( generator_table.matches( generator, prime ) )
+            return generator_table;
+        scratch = math::fixed_base<T>( generator, prime, math::bit_length( prime ) );
+        return scratch;
+    }
+
+    template< typename T >
+    int dealer_information<T>::share_index( int id ) const {
+        // The IDs are handed out in increasing order, so valid_shares is sorted.
+        auto it = std::lower_bound( valid_shares.begin(), valid_shares.end(), id,
+            []( const share<T> & s, int id ) { return s.id < id; }
+        );
+        if( it == valid_shares.end() || it->id != id )
+            return -1;
+        return it - valid_shares.begin();
+    }
+
+    template< typename T >
+    void dealer_information<T>::check_noticeboard(
+        const noticeboard<T> & board,
+        T secret,
+        int threshold
+    ) const {
+        if( board.groups.empty() )
+            return;
+        const group_data<T> & data = board.groups[0];
+        if( threshold < 0 || data.group.size() != (std::size_t) threshold )
+            throw std::invalid_argument( "The threshold does not match the noticeboard." );
+
+        // Recover the secret of the first group and compare.
+        math::exponent_ring<T> exponents( prime - 1 );
+        T power = 1;
+        for( int id : data.group ) {
+            int index = share_index( id );
+            if( index < 0 )
+                throw std::invalid_argument( "The board has groups with unknown shares." );
+            power = exponents.multiply( power, valid_shares[index].share );
+        }
+        T V_X = math::pow_mod( data.group_generator, power, prime );
+        if( (data.group_value + math::pow_mod( generator, V_X, prime )) % prime
+                != secret % prime )
+            throw std::invalid_argument( "The secret does not match the noticeboard." );
+    }
+
+    template< typename T >
+    template< typename RNG >
+    std::size_t dealer_information<T>::extend_noticeboard(
+        noticeboard<T> & board,
+        T secret,
+        int threshold,
+        const std::vector<int> & new_ids,
+        RNG & rng,
+        unsigned threads
+    ) const {
+        check_noticeboard( board, secret, threshold );
+
+        // Split the shares into the new ones and the old ones.
+        std::vector<int> fresh, old;
+        for( std::size_t i = 0; i < valid_shares.size(); i++ ) {
+            if( std::find( new_ids.begin(), new_ids.end(), valid_shares[i].id ) != new_ids.end() )
+                fresh.push_back( i );
+            else
+                old.push_back( i );
+        }
+
+        /* Every group with j new shares and threshold-j old shares,
+         * for j >= 1, is a new group.
+         */
+        std::vector< std::vector<int> > groups;
+        std::size_t size = std::max( threshold, 0 );
+        for( std::size_t j = 1; j <= size && j <= fresh.size(); j++ ) {
+            if( size - j > old.size() )
+                continue;
+            math::combination f( fresh.size(), j );
+            do {
+                math::combination o( old.size(), size - j );
+                do {
+                    std::vector<int> group;
+                    for( int index : f.indexes() )
+                        group.push_back( fresh[index] );
+                    for( int index : o.indexes() )
+                        group.push_back( old[index] );
+                    std::sort( group.begin(), group.end() );
+                    groups.push_back( group );
+                } while( o.next() );
+            } while( f.next() );
+        }
+
+        if( threads == 0 )
+            threads = 1;
+        std::vector< rng::xorshift > streams;
+        for( unsigned i = 0; i < threads; i++ )
+            streams.emplace_back( rng(), rng(), rng(), rng() );
+
+        math::fixed_base<T> scratch;
+        const auto & f = generator_powers( scratch );
+        std::size_t first = board.groups.size();
+        board.groups.resize( first + groups.size() );
+        parallel::parallel_for( 0, groups.size(), threads,
+            [&]( std::size_t i, unsigned worker ) {
+                fill_group( board.groups[first + i], groups[i], secret, f, streams[worker] );
+            },
+            64
+        );
+
+        std::sort( board.groups.begin(), board.groups.end(),
+            []( const group_data<T> & a, const group_data<T> & b ) {
+                return a.group < b.group;
+            }
+        );
+        board.build_index();
+        return groups.size();
+    }
+
+    template< typename T >
+    std::size_t dealer_information<T>::prune_noticeboard( noticeboard<T> & board, int id ) {
+        auto end = std::remove_if( board.groups.begin(), board.groups.end(),
+            [id]( const group_data<T> & data ) {
+                return std::find( data.group.begin(), data.group.end(), id )
+                    != data.group.end();
+            }
+        );
+        std::size_t removed = board.groups.end() - end;
+        board.groups.erase( end, board.groups.end() );
+        board.build_index();
+        return removed;
     }
 
 }
@@ -0,0 +1,60 @@
+#ifndef PINCH_JOURNAL_HPP
+#define PINCH_JOURNAL_HPP
+
+/* Journal of the changes made to a dealer's noticeboard.
+ *
+ * When the noticeboard is updated incrementally
+ * (see dealer_information::extend_noticeboard and prune_noticeboard),
+ * the dealer appends one entry per change to the journal,
+ * so that the history of the board can be audited later.
+ *
+ * File format:
+ * One entry per line: the time of the change (seconds since the epoch),
+ * the action and its argument, separated by whitespace.
+ * The actions are:
+ *  add <id>            groups for the share <id> were added;
+ *  remove <id>         groups containing <id> were removed;
+ *  rotate <threshold>  the whole board was regenerated with a new secret.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace pinch {
+
+    struct journal_entry {
+        std::int64_t time;
+        std::string action;
+        int argument;
+    };
+
+    // Creates an entry with the current time.
+    inline journal_entry make_journal_entry( std::string action, int argument ) {
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        return {
+            std::chrono::duration_cast< std::chrono::seconds >( now ).count(),
+            action,
+            argument
+        };
+    }
+
+    inline std::ostream & operator<<( std::ostream & os, const journal_entry & e ) {
+        return os << e.time << ' ' << e.action << ' ' << e.argument;
+    }
+
+    inline std::istream & operator>>( std::istream & is, journal_entry & e ) {
+        return is >> e.time >> e.action >> e.argument;
+    }
+
+    // Appends the entry to the given journal file.
+    inline void append_journal( const std::string & filename, const journal_entry & e ) {
+        std::ofstream file( filename, std::ios::app );
+        file << e << '\n';
+    }
+
+} // namespace pinch
+
+#endif // PINCH_JOURNAL_HPP
@@ -24,10 +24,17 @@
  * The generator and prime_modulo (parameters for f) in a single line,
  * separated by whitespace;
  * then, one group_data per line.
+ *
+ * The noticeboard keeps a hash index from groups to their positions,
+ * so that retrieving the data of a group does not scan the whole board.
  */
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace pinch {
@@ -38,20 +45,92 @@ namespace pinch {
         std::vector<int> group;
     };
 
+    /* Hash of a list of user IDs.
+     */
+    inline std::uint64_t group_hash( const std::vector<int> & group ) {
+        // FNV-1a, one ID at a time.
+        std::uint64_t hash = 14695981039346656037ull;
+        for( int id : group ) {
+            hash ^= (std::uint32_t) id;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
     template< typename T >
     struct noticeboard {
         T generator, prime_modulo; // Parameters for the function f
         std::vector< group_data<T> > groups;
 
-        // Retrieves the group_data corresponding to the given group.
-        group_data<T> retrieve_data( std::vector<int> group ) const;
+        /* Maps group_hash(group) to the position of the group in 'groups'.
+         * Groups with colliding hashes are told apart during the lookup.
+         */
+        std::unordered_multimap< std::uint64_t, std::size_t > index;
+
+        /* Rebuilds the index.
+         * Reading the board from a stream or generating, extending
+         * and pruning it through dealer_information already does this;
+         * call it again after changing 'groups' directly.
+         */
+        void build_index();
+
+        /* Replaces the group at the given position, keeping the index current.
+         */
+        void replace_group( std::size_t position, group_data<T> data );
+
+        /* Whether the index covers every group.
+         * Adding or removing groups directly makes it stale;
+         * changing a group in place is not detected,
+         * so do it through replace_group or call build_index afterwards.
+         */
+        bool index_current() const { return index.size() == groups.size(); }
+
+        /* Retrieves the group_data corresponding to the given group.
+         * If the index is stale, the board is scanned linearly.
+         */
+        const group_data<T> & retrieve_data( const std::vector<int> & group ) const;
     };
 
     template< typename T >
-    group_data<T> noticeboard<T>::retrieve_data( std::vector<int> group ) const {
-        for( int i = 0; i < groups.size(); i++ )
-            if( groups[i].group == group )
-                return groups[i];
+    void noticeboard<T>::build_index() {
+        index.clear();
+        index.reserve( groups.size() );
+        for( std::size_t i = 0; i < groups.size(); i++ )
+            index.emplace( group_hash( groups[i].group ), i );
+    }
+
+    template< typename T >
+    void noticeboard<T>::replace_group( std::size_t position, group_data<T> data ) {
+        if( !index_current() ) {
+            // A stale index stays stale until build_index.
+            groups.at( position ) = std::move( data );
+            return;
+        }
+        auto range = index.equal_range( group_hash( groups.at( position ).group ) );
+        for( auto it = range.first; it != range.second; ++it )
+            if( it->second == position ) {
+                index.erase( it );
+                break;
+            }
+        index.emplace( group_hash( data.group ), position );
+        groups[position] = std::move( data );
+    }
+
+    template< typename T >
+    const group_data<T> & noticeboard<T>::retrieve_data(
+        const std::vector<int> & group
+    ) const {
+        if( index_current() ) {
+            auto range = index.equal_range( group_hash( group ) );
+            for( auto it = range.first; it != range.second; ++it )
+                if( groups[it->second].group == group )
+                    return groups[it->second];
+        }
+        else {
+            for( std::size_t i = 0; i < groups.size(); i++ )
+                if( groups[i].group == group )
+                    return groups[i];
+        }
         throw std::out_of_range( "Specified group not in the noticeboard." );
     }
 
@@ -85,6 +164,7 @@ namespace pinch {
         group_data<T> data;
         while( is >> data )
             board.groups.push_back( data );
+        board.build_index();
 
         is.clear(); // TODO: maybe not a good idea
         return is;
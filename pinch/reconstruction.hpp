@@ -0,0 +1,225 @@
+#ifndef PINCH_RECONSTRUCTION_HPP
+#define PINCH_RECONSTRUCTION_HPP
+
+/* In-process coordinator for many concurrent Pinch reconstructions.
+ *
+ * In the command line tools, each reconstruction is a serial relay:
+ * the starter writes a message to a file, and every other user of the group
+ * joins its share to it and passes it on; at last the starter finishes.
+ * Here, every user is a pipeline stage running in its own thread,
+ * and the files are replaced by parallel::channel's.
+ * While one user raises the partial message of a group to its share,
+ * the other users are busy with the messages of other groups,
+ * so a batch of reconstructions keeps every stage working at once.
+ *
+ * Inside the pipeline, the remaining users of a reconstruction
+ * are a bitmask over the positions of its group,
+ * so groups may have at most 64 members.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "math/fixed_base.hpp"
+#include "parallel/channel.hpp"
+#include "pinch/shares.hpp"
+#include "pinch/user_data.hpp"
+#include "random/xorshift.hpp"
+
+namespace pinch {
+
+    /* Throughput of a batch of reconstructions.
+     */
+    struct reconstruction_stats {
+        std::size_t reconstructions = 0;
+        double seconds = 0;
+
+        double per_second() const {
+            return seconds > 0 ? reconstructions / seconds : 0;
+        }
+    };
+
+    template< typename T >
+    class reconstruction_coordinator {
+    public:
+        /* Coordinator for the users that own the given shares.
+         */
+        explicit reconstruction_coordinator( std::vector< share<T> > shares );
+
+        /* Reconstructs the secret once for each group,
+         * and returns the secrets in the same order as the groups.
+         * Each group must be sorted, and its first user is the starter.
+         *
+         * One thread is started for each share; they live until the batch ends.
+         * At most window reconstructions are in the pipeline at once;
+         * 0 means four times the number of shares.
+         * The RNG seeds the generators that the stages use for the nonces.
+         * For batches of at least 8 groups, a math::fixed_base table
+         * for the board's generator is built to finish the reconstructions.
+         *
+         * If a reconstruction fails (for instance, because its group
+         * is not in the board), the first such error is rethrown
+         * after every stage is stopped.
+         */
+        template< typename Board, typename RNG >
+        std::vector<T> reconstruct(
+            const Board & board,
+            const std::vector< std::vector<int> > & groups,
+            RNG & rng,
+            std::size_t window = 0,
+            reconstruction_stats * stats = nullptr
+        ) const;
+
+    private:
+        std::vector< share<T> > shares;
+        std::unordered_map< int, std::size_t > stage_of; // id -> position in shares
+
+        struct job {
+            std::size_t index;               // Position in the result vector
+            const std::vector<int> * group;
+            std::vector< std::size_t > route; // Stage of each member of the group
+            std::uint64_t remaining;         // Bit i set: group[i] did not join yet
+            bool started = false;
+            message<T> msg;
+            private_nonce<T> nonce;
+            T secret;
+            std::exception_ptr error;
+        };
+    };
+
+// Implementation
+
+    template< typename T >
+    reconstruction_coordinator<T>::reconstruction_coordinator(
+        std::vector< share<T> > shares
+    ) :
+        shares( std::move(shares) )
+    {
+        for( std::size_t i = 0; i < this->shares.size(); i++ )
+            stage_of[this->shares[i].id] = i;
+    }
+
+    template< typename T >
+    template< typename Board, typename RNG >
+    std::vector<T> reconstruction_coordinator<T>::reconstruct(
+        const Board & board,
+        const std::vector< std::vector<int> > & groups,
+        RNG & rng,
+        std::size_t window,
+        reconstruction_stats * stats
+    ) const {
+        using job_ptr = std::unique_ptr< job >;
+
+        // Validate every group before any thread is started.
+        std::vector< std::vector< std::size_t > > routes( groups.size() );
+        for( std::size_t i = 0; i < groups.size(); i++ ) {
+            if( groups[i].empty() || groups[i].size() > 64 )
+                throw std::invalid_argument( "Groups must have between 1 and 64 users." );
+            for( int id : groups[i] ) {
+                auto it = stage_of.find( id );
+                if( it == stage_of.end() )
+                    throw std::out_of_range( "There is no share with this id." );
+                routes[i].push_back( it->second );
+            }
+        }
+        if( window == 0 )
+            window = 4 * shares.size();
+
+        auto start_time = std::chrono::steady_clock::now();
+
+        math::fixed_base<T> f;
+        if( groups.size() >= 8 )
+            f = math::fixed_base<T>( board.generator, board.prime_modulo,
+                math::bit_length( board.prime_modulo ) );
+
+        std::vector< parallel::channel< job_ptr > > inbox( shares.size() );
+        parallel::channel< job_ptr > results;
+
+        std::vector< std::thread > stages;
+        for( std::size_t s = 0; s < shares.size(); s++ )
+            stages.emplace_back( [&, s]( rng::xorshift stage_rng ) {
+                const share<T> & own = shares[s];
+                job_ptr j;
+                while( inbox[s].pop( j ) ) {
+                    try {
+                        if( !j->started ) {
+                            std::vector<int> others( j->group->begin() + 1, j->group->end() );
+                            auto pair = own.start_reconstruction( board, others, stage_rng );
+                            j->msg = std::move( pair.first );
+                            j->msg.remaining_ids.clear(); // Tracked by the bitmask
+                            j->nonce = pair.second;
+                            j->started = true;
+                        }
+                        else if( j->remaining != 0 ) {
+                            // The lowest remaining bit is this stage.
+                            j->msg.partial_message =
+                                own.contribute( j->msg.partial_message, j->msg.prime_modulo );
+                            j->remaining &= j->remaining - 1;
+                        }
+                        else {
+                            j->secret = j->nonce.reconstruct( j->msg, f );
+                            results.push( std::move(j) );
+                            continue;
+                        }
+                    } catch( ... ) {
+                        j->error = std::current_exception();
+                        results.push( std::move(j) );
+                        continue;
+                    }
+
+                    std::size_t next = j->remaining == 0 ? 0 : __builtin_ctzll( j->remaining );
+                    inbox[j->route[next]].push( std::move(j) );
+                }
+            }, rng::xorshift( rng(), rng(), rng(), rng() ) );
+
+        std::vector<T> secrets( groups.size() );
+        std::exception_ptr error;
+        std::size_t submitted = 0, done = 0;
+        while( done < groups.size() ) {
+            for( ; submitted < groups.size() && submitted - done < window; submitted++ ) {
+                job_ptr j( new job );
+                j->index = submitted;
+                j->group = &groups[submitted];
+                j->route = std::move( routes[submitted] );
+                std::size_t n = j->group->size();
+                j->remaining = (n == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << n) - 1)
+                    & ~std::uint64_t(1); // The starter joins in start_reconstruction
+                inbox[j->route[0]].push( std::move(j) );
+            }
+
+            job_ptr j;
+            results.pop( j );
+            done++;
+            if( j->error ) {
+                if( !error )
+                    error = j->error;
+            }
+            else
+                secrets[j->index] = std::move( j->secret );
+        }
+
+        for( auto & channel : inbox )
+            channel.close();
+        for( auto & thread : stages )
+            thread.join();
+
+        if( error )
+            std::rethrow_exception( error );
+
+        if( stats ) {
+            stats->reconstructions = groups.size();
+            stats->seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start_time
+                ).count();
+        }
+        return secrets;
+    }
+
+} // namespace pinch
+
+#endif // PINCH_RECONSTRUCTION_HPP
@@ -0,0 +1,196 @@
+#ifndef PINCH_SHARDED_NOTICEBOARD_HPP
+#define PINCH_SHARDED_NOTICEBOARD_HPP
+
+/* Noticeboard split into several binary noticeboard files.
+ *
+ * For large user populations, the C(n, k) groups do not fit in memory.
+ * A sharded board partitions the groups by their lexicographic rank
+ * (see math::combination) into ranges; each range is an independent
+ * binary noticeboard (see pinch/binary_noticeboard.hpp) with contiguous
+ * ranks, so each shard can be generated by a different process,
+ * and written while it is generated
+ * (see dealer_information::write_noticeboard_shard).
+ *
+ * The manifest is a small text file that lists the shards.
+ * File format (manifest):
+ * The tag PINCH-SHARDS, followed by the number of users, the threshold,
+ * the total number of groups and the number of shards;
+ * then, for each shard, in increasing order of rank, a line with
+ * its first rank, its number of groups and its file name.
+ * Relative file names are relative to the directory of the manifest.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "math/set.hpp"
+#include "pinch/binary_noticeboard.hpp"
+
+namespace pinch {
+
+    const char manifest_tag[] = "PINCH-SHARDS";
+
+    struct shard_entry {
+        std::uint64_t first_rank;
+        std::uint64_t count;
+        std::string file;
+    };
+
+    struct noticeboard_manifest {
+        int users;
+        int threshold;
+        std::uint64_t total;
+        std::vector< shard_entry > shards;
+    };
+
+    /* Splits the C(users, threshold) groups into the given number
+     * of rank ranges, whose sizes differ by at most one.
+     * Shard i is stored in the file prefix.i.
+     * There are never more shards than groups.
+     */
+    inline noticeboard_manifest make_manifest(
+        int users,
+        int threshold,
+        std::size_t shards,
+        const std::string & prefix
+    );
+
+    inline std::ostream & operator<<( std::ostream &, const noticeboard_manifest & );
+    inline std::istream & operator>>( std::istream &, noticeboard_manifest & );
+
+    // Returns true if the given file starts with the manifest tag.
+    inline bool is_noticeboard_manifest( const std::string & filename );
+
+    /* Read-only view of a sharded noticeboard.
+     * Every shard is mapped when the manifest is opened;
+     * retrieve_data computes the rank of the group
+     * and looks it up only in the shard that holds it.
+     */
+    template< typename T >
+    class sharded_noticeboard {
+        noticeboard_manifest manifest;
+        std::vector< std::unique_ptr< mapped_noticeboard<T> > > shards;
+
+    public:
+        T generator, prime_modulo; // Parameters for the function f
+
+        /* Opens the manifest and maps all its shards.
+         * Throws std::runtime_error if some shard is missing
+         * or does not match the manifest.
+         */
+        explicit sharded_noticeboard( const std::string & manifest_file );
+
+        // Total number of groups.
+        std::uint64_t size() const { return manifest.total; }
+
+        std::size_t shard_count() const { return shards.size(); }
+
+        /* Retrieves the group_data corresponding to the given group,
+         * which must be sorted.
+         * Throws std::out_of_range if the group is not in the board.
+         */
+        group_data<T> retrieve_data( const std::vector<int> & group ) const;
+    };
+
+// Implementation
+
+    noticeboard_manifest make_manifest(
+        int users,
+        int threshold,
+        std::size_t shards,
+        const std::string & prefix
+    ) {
+        noticeboard_manifest manifest;
+        manifest.users = users;
+        manifest.threshold = threshold;
+        manifest.total = math::binomial( users, threshold );
+        shards = std::max< std::uint64_t >( 1, std::min< std::uint64_t >( shards, manifest.total ) );
+
+        std::uint64_t first = 0;
+        for( std::size_t i = 0; i < shards; i++ ) {
+            std::uint64_t count = manifest.total / shards + (i < manifest.total % shards);
+            manifest.shards.push_back( {first, count, prefix + '.' + std::to_string(i)} );
+            first += count;
+        }
+        return manifest;
+    }
+
+    std::ostream & operator<<( std::ostream & os, const noticeboard_manifest & m ) {
+        os << manifest_tag << ' ' << m.users << ' ' << m.threshold << ' '
+            << m.total << ' ' << m.shards.size() << '\n';
+        for( const auto & shard : m.shards )
+            os << shard.first_rank << ' ' << shard.count << ' ' << shard.file << '\n';
+        return os;
+    }
+
+    std::istream & operator>>( std::istream & is, noticeboard_manifest & m ) {
+        std::string tag;
+        std::size_t shards;
+        is >> tag;
+        if( tag != manifest_tag ) {
+            is.setstate( std::ios::failbit );
+            return is;
+        }
+        is >> m.users >> m.threshold >> m.total >> shards;
+        m.shards.resize( shards );
+        for( auto & shard : m.shards )
+            is >> shard.first_rank >> shard.count >> shard.file;
+        return is;
+    }
+
+    bool is_noticeboard_manifest( const std::string & filename ) {
+        std::ifstream file( filename );
+        std::string tag;
+        return file >> tag && tag == manifest_tag;
+    }
+
+    template< typename T >
+    sharded_noticeboard<T>::sharded_noticeboard( const std::string & manifest_file ) {
+        std::ifstream file( manifest_file );
+        if( !(file >> manifest) || manifest.shards.empty() )
+            throw std::runtime_error( manifest_file + " is not a noticeboard manifest." );
+
+        std::string directory;
+        auto slash = manifest_file.rfind( '/' );
+        if( slash != std::string::npos )
+            directory = manifest_file.substr( 0, slash + 1 );
+
+        std::uint64_t next_rank = 0;
+        for( const auto & entry : manifest.shards ) {
+            std::string name = entry.file[0] == '/' ? entry.file : directory + entry.file;
+            shards.emplace_back( new mapped_noticeboard<T>( name ) );
+            const auto & shard = *shards.back();
+            if( entry.first_rank != next_rank || shard.first_rank() != entry.first_rank
+                    || shard.size() != entry.count
+                    || shard.threshold() != manifest.threshold
+                    || shard.users() != shards[0]->users() )
+                throw std::runtime_error( name + " does not match the manifest." );
+            next_rank += entry.count;
+        }
+        if( next_rank != manifest.total )
+            throw std::runtime_error( manifest_file + ": the shards do not cover the board." );
+
+        generator = shards[0]->generator;
+        prime_modulo = shards[0]->prime_modulo;
+    }
+
+    template< typename T >
+    group_data<T> sharded_noticeboard<T>::retrieve_data( const std::vector<int> & group ) const {
+        std::uint64_t rank = shards[0]->rank_of( group );
+        // Last shard whose first rank is at most rank.
+        auto it = std::upper_bound( manifest.shards.begin(), manifest.shards.end(), rank,
+            []( std::uint64_t rank, const shard_entry & shard ) {
+                return rank < shard.first_rank;
+            }
+        );
+        return shards[it - manifest.shards.begin() - 1]->retrieve_data( group );
+    }
+
+} // namespace pinch
+
+#endif // PINCH_SHARDED_NOTICEBOARD_HPP
@@ -11,7 +11,9 @@
 #include <algorithm>
 #include <iostream>
 #include <utility> // std::pair
+#include "instrument/instrument.hpp"
 #include "math/algo.hpp"
+#include "math/exponent_ring.hpp"
 #include "pinch/user_data.hpp"
 #include "pinch/noticeboard.hpp" // TODO: circular inclusion; may cause problems
 #include "random/gmp_adapter.hpp"
@@ -29,11 +31,15 @@ namespace pinch {
         /* Start the reconstruction of the shares,
          * using the given RNG to generate the secret nonce.
          *
+         * The board may be a noticeboard<T> or a mapped_noticeboard<T>;
+         * any type with the members generator, prime_modulo
+         * and retrieve_data will do.
+         *
          * The user list must not include this ID.
          */
-        template< typename RNG >
+        template< typename Board, typename RNG >
         std::pair< message<T>, private_nonce<T> > start_reconstruction(
-            const noticeboard<T> & board,
+            const Board & board,
             std::vector< int > users,
             RNG & rng
         ) const;
@@ -41,6 +47,12 @@ namespace pinch {
         /* Join this share to the given message.
          */
         void join( message<T> & ) const;
+
+        /* Returns this user's contribution to a partial message;
+         * that is, partial_message^share mod prime_modulo.
+         * This is the work done by join.
+         */
+        T contribute( const T & partial_message, const T & prime_modulo ) const;
     };
 
     template< typename T >
@@ -54,22 +66,23 @@ namespace pinch {
     }
 
     template< typename T >
-    template< typename RNG >
+    template< typename Board, typename RNG >
     std::pair< message<T>, private_nonce<T> > share<T>::start_reconstruction(
-        const noticeboard<T> & board,
+        const Board & board,
         std::vector< int > users,
         RNG & rng
     ) const {
+        instrument::count( instrument::counter::reconstructions );
         message<T> msg;
         private_nonce<T> nonce_holder;
         // First, generate the random nonce.
-        T phi = board.prime_modulo - 1;
-        int bits = mpz_sizeinbase( phi.get_mpz_t(), 2 );
+        math::exponent_ring<T> exponents( board.prime_modulo - 1 );
+        int bits = mpz_sizeinbase( exponents.order().get_mpz_t(), 2 );
         T nonce = rng::gmp_generate( rng, bits );
-        while( math::gcd( nonce, phi ) != 1 )
+        while( math::gcd( nonce, exponents.order() ) != 1 )
             nonce = rng::gmp_generate( rng, bits );
 
-        nonce_holder.nonce_inverse = math::modular_inverse( nonce, phi );
+        nonce_holder.nonce_inverse = exponents.inverse( nonce );
 
         // Next, retrieve the public information about the user list.
         msg.remaining_ids = users;
@@ -84,7 +97,7 @@ namespace pinch {
         // And now, give our contribution to the partial share.
         msg.partial_message = math::pow_mod(
                 data.group_generator,
-                T( nonce * this->share ),
+                exponents.multiply( nonce, this->share ),
                 msg.prime_modulo
             );
 
@@ -93,17 +106,17 @@ namespace pinch {
 
     template< typename T >
     void share<T>::join( message<T> & msg ) const {
-        for( int i = 0; i < msg.remaining_ids.size(); i++ )
-            if( msg.remaining_ids[i] == id ) {
-                msg.partial_message = math::pow_mod(
-                        msg.partial_message,
-                        this->share,
-                        msg.prime_modulo
-                    );
-                msg.remaining_ids.erase( msg.remaining_ids.begin() + i );
-                return;
-            }
-        throw std::out_of_range( "The share of this id is not on the message's group." );
+        auto it = std::find( msg.remaining_ids.begin(), msg.remaining_ids.end(), id );
+        if( it == msg.remaining_ids.end() )
+            throw std::out_of_range( "The share of this id is not on the message's group." );
+
+        msg.partial_message = contribute( msg.partial_message, msg.prime_modulo );
+        msg.remaining_ids.erase( it );
+    }
+
+    template< typename T >
+    T share<T>::contribute( const T & partial_message, const T & prime_modulo ) const {
+        return math::pow_mod( partial_message, this->share, prime_modulo );
     }
 }
 
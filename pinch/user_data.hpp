@@ -12,7 +12,9 @@
 #include <stdexcept>
 #include <vector>
 #include <iostream>
+#include "instrument/instrument.hpp"
 #include "math/algo.hpp"
+#include "math/fixed_base.hpp"
 
 namespace pinch {
 
@@ -33,15 +35,30 @@ namespace pinch {
         /* Reconstruct the secret using a complete message.
          */
         T reconstruct( const message<T> & ) const;
+
+        /* Same as above, but f(V) is computed with the given table
+         * if it matches the message's generator and prime.
+         */
+        T reconstruct( const message<T> &, const math::fixed_base<T> & f ) const;
     };
 
     template< typename T >
     T private_nonce<T>::reconstruct( const message<T> & msg ) const {
+        return reconstruct( msg, math::fixed_base<T>() );
+    }
+
+    template< typename T >
+    T private_nonce<T>::reconstruct(
+        const message<T> & msg,
+        const math::fixed_base<T> & f
+    ) const {
+        instrument::scoped_timer timer( instrument::timer::reconstruct );
         if( msg.remaining_ids.size() != 0 )
             throw std::invalid_argument( "The message must be final." );
 
         T V_X = math::pow_mod( msg.partial_message, nonce_inverse, msg.prime_modulo );
-        T f_V_X = math::pow_mod( msg.generator, V_X, msg.prime_modulo );
+        T f_V_X = f.matches( msg.generator, msg.prime_modulo ) ? f.pow( V_X )
+            : math::pow_mod( msg.generator, V_X, msg.prime_modulo );
         return (msg.group_data + f_V_X) % msg.prime_modulo;
     }
 
@@ -20,6 +20,19 @@ namespace command_line {
 "    and be kept private.\n"
 "    Multiple calls to --add may be done simultaneously.\n"
 "\n"
+"--issue <N> <directory>\n"
+"    Add N users to the database at once, storing each share\n"
+"    in the file <directory>/<id>.share; the directory is created if needed.\n"
+"    The shares are generated in parallel (see --threads).\n"
+"    As with --add, these files must be sent through a secure channel.\n"
+"\n"
+"--binary-database\n"
+"    Store the share database in the binary format\n"
+"    (see pinch/dealer_database.hpp), converting it if it is in text.\n"
+"    In this format, --add, --issue and --remove update the file in place,\n"
+"    instead of rewriting it.\n"
+"    Binary databases are recognized automatically.\n"
+"\n"
 "--remove <N>\n"
 "    Remove the share of the user with the given ID.\n"
 "    The ID is avaliable as the first value of the file that stores the share,\n"
@@ -37,21 +50,92 @@ namespace command_line {
 "\n"
 "--threshold <N>\n"
 "    Chooses the threshold of the scheme.\n"
-"    See the option --noticeboard.\n"
+"    See the options --noticeboard and --update-noticeboard.\n"
+"\n"
+"--update-noticeboard <file>\n"
+"    Update an existing noticeboard, keeping its secret:\n"
+"    groups containing the users removed with --remove are dropped,\n"
+"    and groups for the users added with --add are created.\n"
+"    Only the affected groups are generated.\n"
+"    --secret must be the secret of the board;\n"
+"    the threshold defaults to the size of the groups in the board,\n"
+"    and --threshold, if given, must be equal to it.\n"
+"    Both are checked before any share is added or removed.\n"
+"    The board is written back in the same format it was read.\n"
+"\n"
+"--journal <file>\n"
+"    Append to this file a line for each user added or removed,\n"
+"    and for each noticeboard generated from scratch.\n"
+"    See pinch/journal.hpp for the format.\n"
+"\n"
+"--threads <N>\n"
+"    Number of threads used to generate the noticeboard and the shares.\n"
+"    Default: number of processors.\n"
+"\n"
+"--progress\n"
+"    Report the progress of the noticeboard generation to stderr.\n"
+"\n"
+"--binary\n"
+"    Write the noticeboard in the binary, memory-mappable format\n"
+"    (see pinch/binary_noticeboard.hpp) instead of text.\n"
+"    pinch_user recognizes both formats.\n"
+"\n"
+"--fixed-base <file>\n"
+"    Keep in this file the table of powers of the generator\n"
+"    used to speed up the noticeboard generation\n"
+"    (see math/fixed_base.hpp).\n"
+"    If the file holds a table for the database's generator and prime,\n"
+"    it is used; otherwise, the table is built and written to the file.\n"
+"    Without this option, the table is built for each generation.\n"
+"\n"
+"--shards <N>\n"
+"    Generate a sharded noticeboard: the groups are split into N ranges\n"
+"    of consecutive ranks, and each range is written to a binary noticeboard\n"
+"    named <file>.<i>, where <file> is the one given to --noticeboard.\n"
+"    <file> itself is written as the manifest that lists the shards\n"
+"    (see pinch/sharded_noticeboard.hpp).\n"
+"    Each shard is written while it is generated, in bounded memory.\n"
+"    pinch_user accepts the manifest as a noticeboard.\n"
+"\n"
+"--only-shard <i>\n"
+"    Together with --shards, generate only the shard i (counting from 0),\n"
+"    so that several processes may generate the shards simultaneously.\n"
+"    The manifest is written only by the process that generates shard 0,\n"
+"    and the share database is not modified,\n"
+"    so --add and --remove are not allowed.\n"
+"\n"
+"--convert-noticeboard <text board> <binary board>\n"
+"    Convert an existing text noticeboard to the binary format and quit.\n"
+"    No share database is needed for this option.\n"
+"\n"
+"--stats\n"
+"    Writes the instrumentation counters to the standard error at exit\n"
+"    (see instrument/instrument.hpp; needs a build with -DINSTRUMENT).\n"
 "\n"
 "--help\n"
 "    Displays this help and quit.\n"
 ;
 } // namespace command_line
 
+#include <cstdio>
 #include <cstdlib>
 #include <fstream>
+#include <memory>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
+#include <sys/stat.h>
 #include <gmpxx.h>
 #include "cmdline/args.hpp"
+#include "instrument/instrument.hpp"
+#include "math/fixed_base.hpp"
+#include "parallel/parallel_for.hpp"
+#include "pinch/binary_noticeboard.hpp"
+#include "pinch/dealer_database.hpp"
 #include "pinch/dealer_information.hpp"
+#include "pinch/journal.hpp"
+#include "pinch/sharded_noticeboard.hpp"
 #include "random/xorshift.hpp"
 
 namespace command_line {
@@ -61,11 +145,23 @@ namespace command_line {
     mpz_class generator;
 
     std::vector< std::string > added_users;
+    std::size_t issued_users = 0;
+    std::string issue_directory;
+    bool binary_database = false;
     std::vector< int > removed_users;
 
     std::string noticeboard_file;
+    std::string update_file;
+    std::string journal_file;
+    std::string fixed_base_file;
     mpz_class secret;
-    int threshold;
+    int threshold = 0;
+    unsigned threads = parallel::default_threads();
+    bool progress = false;
+    bool binary = false;
+    std::size_t shards = 0;
+    long only_shard = -1;
+    std::string convert_from, convert_to;
 
     void parse( cmdline::args && args ) {
         while( args.size() > 0 ) {
@@ -84,6 +180,15 @@ namespace command_line {
                 added_users.push_back( args.next() );
                 continue;
             }
+            if( arg == "--issue" ) {
+                args.range( 1 ) >> issued_users;
+                issue_directory = args.next();
+                continue;
+            }
+            if( arg == "--binary-database" ) {
+                binary_database = true;
+                continue;
+            }
             if( arg == "--remove" ) {
                 int n;
                 args.range( 1 ) >> n;
@@ -94,6 +199,18 @@ namespace command_line {
                 noticeboard_file = args.next();
                 continue;
             }
+            if( arg == "--update-noticeboard" ) {
+                update_file = args.next();
+                continue;
+            }
+            if( arg == "--journal" ) {
+                journal_file = args.next();
+                continue;
+            }
+            if( arg == "--fixed-base" ) {
+                fixed_base_file = args.next();
+                continue;
+            }
             if( arg == "--secret" ) {
                 args.range( 1 ) >> secret;
                 continue;
@@ -102,6 +219,35 @@ namespace command_line {
                 args.range( 1 ) >> threshold;
                 continue;
             }
+            if( arg == "--threads" ) {
+                args.range( 1 ) >> threads;
+                continue;
+            }
+            if( arg == "--progress" ) {
+                progress = true;
+                continue;
+            }
+            if( arg == "--binary" ) {
+                binary = true;
+                continue;
+            }
+            if( arg == "--shards" ) {
+                args.range( 1 ) >> shards;
+                continue;
+            }
+            if( arg == "--only-shard" ) {
+                args.range( 0 ) >> only_shard;
+                continue;
+            }
+            if( arg == "--convert-noticeboard" ) {
+                convert_from = args.next();
+                convert_to = args.next();
+                continue;
+            }
+            if( arg == "--stats" ) {
+                instrument::report_at_exit();
+                continue;
+            }
             if( arg == "--help" ) {
                 std::cout << "Usage: " << args.program_name() << help_message;
                 std::exit( 0 );
@@ -115,6 +261,16 @@ namespace command_line {
                 std::exit(1);
             }
         }
+        if( only_shard >= 0 ) {
+            if( shards == 0 || (std::size_t) only_shard >= shards ) {
+                std::cerr << "--only-shard must be less than the number given to --shards.\n";
+                std::exit(1);
+            }
+            if( !added_users.empty() || issued_users != 0 || !removed_users.empty() ) {
+                std::cerr << "--add, --issue and --remove cannot be used with --only-shard.\n";
+                std::exit(1);
+            }
+        }
         if( generate_share_database ) {
             if( prime_number == 0 ) {
                 std::cerr << "Provide a prime number with the option --prime.\n";
@@ -132,38 +288,229 @@ int main( int argc, char ** argv ) {
     command_line::parse( cmdline::args( argc, argv ) );
     rng::xorshift rng;
 
+    if( command_line::convert_from != "" ) {
+        pinch::noticeboard<mpz_class> board;
+        std::ifstream text( command_line::convert_from );
+        text >> board;
+        std::ofstream binary( command_line::convert_to, std::ios::binary );
+        pinch::write_binary_noticeboard( binary, board );
+        return 0;
+    }
+
     // Set up database and the file
     pinch::dealer_information<mpz_class> database;
+    std::unique_ptr< pinch::dealer_database<mpz_class> > binary_database;
     if( command_line::generate_share_database ) {
         database.prime = command_line::prime_number;
         database.generator = command_line::generator;
+        if( command_line::binary_database )
+            pinch::dealer_database<mpz_class>::create( command_line::share_database, database );
+    }
+    else if( pinch::binary::is_dealer_database( command_line::share_database ) ) {
+        // Only the header is needed to add and remove shares.
+        binary_database.reset( new pinch::dealer_database<mpz_class>(
+                command_line::share_database ) );
+        if( command_line::noticeboard_file != "" || command_line::update_file != "" )
+            database = binary_database->load();
+        else
+            database = binary_database->header();
     }
     else {
         // Database exists.
         std::ifstream file( command_line::share_database );
         file >> database;
+        if( command_line::binary_database )
+            pinch::dealer_database<mpz_class>::create( command_line::share_database, database );
     }
+    if( command_line::binary_database && !binary_database )
+        binary_database.reset( new pinch::dealer_database<mpz_class>(
+                command_line::share_database ) );
 
-    // Add all the needed users
+    auto journal = [&]( std::string action, int argument ) {
+        if( command_line::journal_file != "" )
+            pinch::append_journal( command_line::journal_file,
+                pinch::make_journal_entry( action, argument ) );
+    };
+
+    /* Load and check the board to update before handing out any share,
+     * so that a wrong secret or threshold leaves every file untouched.
+     */
+    pinch::noticeboard<mpz_class> board;
+    bool binary_board = false;
+    int threshold = command_line::threshold;
+    if( command_line::update_file != "" ) {
+        binary_board = pinch::binary::is_binary_noticeboard( command_line::update_file );
+        if( binary_board )
+            board = pinch::mapped_noticeboard<mpz_class>( command_line::update_file ).load();
+        else {
+            std::ifstream file( command_line::update_file );
+            file >> board;
+        }
+
+        if( threshold == 0 && !board.groups.empty() )
+            threshold = board.groups[0].group.size();
+        if( threshold == 0 ) {
+            std::cerr << "The board is empty; provide the threshold with --threshold.\n";
+            return 1;
+        }
+        try {
+            database.check_noticeboard( board, command_line::secret, threshold );
+        }
+        catch( std::invalid_argument & e ) {
+            std::cerr << "Error: " << e.what() << '\n';
+            return 1;
+        }
+    }
+
+    /* Add all the needed users.
+     * The shares are recorded in the database only after every share file
+     * was written; otherwise, the files already written are removed,
+     * so that no user holds a share the database does not know.
+     */
+    std::vector< int > added_ids;
+    std::vector< pinch::share<mpz_class> > added_shares;
+    std::vector< std::string > share_files;
+    auto write_share = [&]( const std::string & filename, const pinch::share<mpz_class> & share ) {
+        std::ofstream share_file( filename );
+        share_files.push_back( filename );
+        share_file << share << '\n';
+        share_file.close();
+        if( share_file )
+            return true;
+        std::cerr << "Error: could not write the share " << share.id
+            << " to " << filename << ".\n";
+        for( const auto & name : share_files )
+            std::remove( name.c_str() );
+        return false;
+    };
     for( std::string share_filename : command_line::added_users ) {
-        std::ofstream share( share_filename );
-        share << database.new_share( rng ) << '\n';
+        auto share = database.new_share( rng );
+        if( !write_share( share_filename, share ) )
+            return 1;
+        added_shares.push_back( share );
+    }
+    if( command_line::issued_users != 0 ) {
+        mkdir( command_line::issue_directory.c_str(), 0700 );
+        auto issued = database.issue_shares( command_line::issued_users, rng,
+            command_line::threads );
+        for( const auto & share : issued )
+            if( !write_share( command_line::issue_directory + '/'
+                    + std::to_string( share.id ) + ".share", share ) )
+                return 1;
+        added_shares.insert( added_shares.end(), issued.begin(), issued.end() );
+    }
+    if( binary_database )
+        binary_database->append( added_shares );
+    for( const auto & share : added_shares ) {
+        added_ids.push_back( share.id );
+        journal( "add", share.id );
     }
 
     // Remove the requested IDs
-    for( int id : command_line::removed_users )
-        if( !database.remove_share(id) )
+    for( int id : command_line::removed_users ) {
+        bool removed = binary_database ? binary_database->remove( id ) : database.remove_share( id );
+        if( binary_database )
+            database.remove_share( id );
+        if( !removed )
             std::cerr << "Error: user " << id << " not found in the database.\n";
+        else
+            journal( "remove", id );
+    }
+
+    // Load or build the table of powers of the generator
+    if( command_line::fixed_base_file != "" ) {
+        std::ifstream file( command_line::fixed_base_file );
+        file >> database.generator_table;
+        if( !database.generator_table.matches( database.generator, database.prime ) ) {
+            database.generator_table = math::fixed_base<mpz_class>(
+                database.generator, database.prime, math::bit_length( database.prime ) );
+            std::ofstream out( command_line::fixed_base_file, std::ios::trunc );
+            out << database.generator_table;
+        }
+    }
+
+    /* Update the noticeboard incrementally.
+     * The new board is written to a temporary file and renamed over the old one,
+     * so a failed write leaves the old board intact.
+     * The database is written even then, to keep the shares just handed out.
+     */
+    int status = 0;
+    if( command_line::update_file != "" ) {
+        std::size_t removed = 0, added = 0;
+        std::string temporary = command_line::update_file + ".tmp";
+        bool written = false;
+        try {
+            for( int id : command_line::removed_users )
+                removed += database.prune_noticeboard( board, id );
+            added = database.extend_noticeboard( board, command_line::secret,
+                threshold, added_ids, rng, command_line::threads );
+
+            std::ofstream file( temporary, std::ios::binary | std::ios::trunc );
+            if( binary_board || command_line::binary )
+                pinch::write_binary_noticeboard( file, board );
+            else
+                file << board;
+            file.close();
+            written = file && std::rename( temporary.c_str(), command_line::update_file.c_str() ) == 0;
+        }
+        catch( std::invalid_argument & e ) {
+            std::cerr << "Error: " << e.what() << '\n';
+        }
+        if( written )
+            std::cerr << "Removed " << removed << " groups, added " << added << " groups.\n";
+        else {
+            std::remove( temporary.c_str() );
+            std::cerr << "Error: could not update " << command_line::update_file
+                << "; it was left unchanged.\n";
+            status = 1;
+        }
+    }
 
+    // Generate a sharded noticeboard
+    if( command_line::noticeboard_file != "" && command_line::shards != 0 ) {
+        std::string prefix = command_line::noticeboard_file;
+        auto slash = prefix.rfind( '/' );
+        auto manifest = pinch::make_manifest( database.valid_shares.size(),
+            command_line::threshold, command_line::shards,
+            slash == std::string::npos ? prefix : prefix.substr( slash + 1 ) );
+
+        for( std::size_t i = 0; i < manifest.shards.size(); i++ ) {
+            if( command_line::only_shard >= 0 && i != (std::size_t) command_line::only_shard )
+                continue;
+            const auto & shard = manifest.shards[i];
+            std::ofstream file( command_line::noticeboard_file + '.' + std::to_string(i),
+                std::ios::binary );
+            database.write_noticeboard_shard( file, command_line::secret,
+                command_line::threshold, shard.first_rank, shard.count, rng,
+                command_line::threads, command_line::progress ? &std::cerr : nullptr );
+        }
+
+        if( command_line::only_shard > 0 )
+            return 0; // The database and the manifest are left to shard 0.
+        std::ofstream manifest_file( command_line::noticeboard_file );
+        manifest_file << manifest;
+        journal( "rotate", command_line::threshold );
+        if( command_line::only_shard == 0 )
+            return 0;
+    }
     // Generate the noticeboard
-    if( command_line::noticeboard_file != "" ) {
-        std::ofstream noticeboard_file( command_line::noticeboard_file );
+    else if( command_line::noticeboard_file != "" ) {
+        std::ofstream noticeboard_file( command_line::noticeboard_file, std::ios::binary );
         pinch::noticeboard<mpz_class> board = database.generate_noticeboard(
-            command_line::secret, command_line::threshold, rng
+            command_line::secret, command_line::threshold, rng,
+            command_line::threads, command_line::progress ? &std::cerr : nullptr
         );
-        noticeboard_file << board;
+        if( command_line::binary )
+            pinch::write_binary_noticeboard( noticeboard_file, board );
+        else
+            noticeboard_file << board;
+        journal( "rotate", command_line::threshold );
     }
 
+    // A binary database was already updated in place.
+    if( binary_database )
+        return status;
+
     /* Write database back to the file
      * We must open a new fstream instead of reusing the one used to read the database
      * because standard file streams support truncation only on opening,
@@ -173,5 +520,5 @@ int main( int argc, char ** argv ) {
     std::ofstream file( command_line::share_database, std::ios::trunc );
     file << database;
 
-    return 0;
+    return status;
 }
@@ -16,6 +16,8 @@ namespace command_line {
 "    random_number is a file that will be generated with a random number\n"
 "    generated only at the beginning of the reconstruction process.\n"
 "\n"
+"    The noticeboard may be in text or in binary format,\n"
+"    or the manifest of a sharded noticeboard.\n"
 "    The file <noticeboard> is public and <passing_message> may be sent freely.\n"
 "    The random number must be kept private; it will be used to finish\n"
 "    the secret reconstruction.\n"
@@ -31,6 +33,10 @@ namespace command_line {
 "    this command uses the random number to finish the reconstruction\n"
 "    and prints to stdout the secret.\n"
 "\n"
+"--stats\n"
+"    Writes the instrumentation counters to the standard error at exit\n"
+"    (see instrument/instrument.hpp; needs a build with -DINSTRUMENT).\n"
+"\n"
 "--help\n"
 "    Displays this help and quit.\n"
 ;
@@ -42,8 +48,11 @@ namespace command_line {
 #include <string>
 #include <gmpxx.h>
 #include "cmdline/args.hpp"
+#include "instrument/instrument.hpp"
+#include "pinch/binary_noticeboard.hpp"
 #include "pinch/shares.hpp"
 #include "pinch/noticeboard.hpp"
+#include "pinch/sharded_noticeboard.hpp"
 #include "random/xorshift.hpp"
 
 namespace command_line {
@@ -76,6 +85,10 @@ namespace command_line {
                 random_file = args.next();
                 continue;
             }
+            if( arg == "--stats" ) {
+                instrument::report_at_exit();
+                continue;
+            }
             if( arg == "--help" ) {
                 std::cout << "Usage: " << args.program_name() << help_message;
                 std::exit( 0 );
@@ -98,15 +111,26 @@ int main( int argc, char ** argv ) {
     rng::xorshift rng;
 
     if( command_line::noticeboard != "" ) {
-        pinch::noticeboard<mpz_class> board;
         pinch::share<mpz_class> share;
         {
-            std::ifstream noticeboard_file( command_line::noticeboard );
             std::ifstream share_file( command_line::share );
-            noticeboard_file >> board;
             share_file >> share;
         }
-        auto pair = share.start_reconstruction( board, command_line::users, rng );
+        std::pair< pinch::message<mpz_class>, pinch::private_nonce<mpz_class> > pair;
+        if( pinch::is_noticeboard_manifest( command_line::noticeboard ) ) {
+            pinch::sharded_noticeboard<mpz_class> board( command_line::noticeboard );
+            pair = share.start_reconstruction( board, command_line::users, rng );
+        }
+        else if( pinch::binary::is_binary_noticeboard( command_line::noticeboard ) ) {
+            pinch::mapped_noticeboard<mpz_class> board( command_line::noticeboard );
+            pair = share.start_reconstruction( board, command_line::users, rng );
+        }
+        else {
+            pinch::noticeboard<mpz_class> board;
+            std::ifstream noticeboard_file( command_line::noticeboard );
+            noticeboard_file >> board;
+            pair = share.start_reconstruction( board, command_line::users, rng );
+        }
         {
             std::ofstream message_file( command_line::message );
             std::ofstream random_file( command_line::random_file );
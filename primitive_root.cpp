@@ -13,13 +13,34 @@ namespace command_line {
 "--sort\n"
 "--sorted\n"
 "    Sort the list of primitive roots in ascending order.\n"
-"    Default: no particular order.\n"
+"    This needs the entire list to be kept in memory.\n"
+"    Default: no particular order;\n"
+"    the roots are written as they are generated, in bounded memory.\n"
+"\n"
+"--safe\n"
+"    Informs the program that the prime is a safe prime;\n"
+"    that is, (p-1)/2 is also prime.\n"
+"    This avoids factoring p-1, which is infeasible for large primes.\n"
+"\n"
+"--factor <N>\n"
+"    Informs the program that N is a prime factor of p-1.\n"
+"    If this option is used, every prime factor of p-1 must be given\n"
+"    (repeated factors may be given only once),\n"
+"    and p-1 will not be factored.\n"
+"\n"
+"--threads <N>\n"
+"    Number of threads used to generate the list of primitive roots.\n"
+"    Default: 1.\n"
 "\n"
 "--root <N>\n"
 "    Informs the program that this number is a primitive root of that prime.\n"
 "    This can be used in conjunction with --all to sped up the generation\n"
 "    of the list of primitive numbers.\n"
 "\n"
+"--stats\n"
+"    Writes the instrumentation counters to the standard error at exit\n"
+"    (see instrument/instrument.hpp; needs a build with -DINSTRUMENT).\n"
+"\n"
 "--help\n"
 "    Displays this help and quit.\n"
 ;
@@ -30,6 +51,7 @@ namespace command_line {
 #include <iostream>
 #include <gmpxx.h>
 #include "cmdline/args.hpp"
+#include "instrument/instrument.hpp"
 #include "math/primitive_root.hpp"
 
 namespace command_line {
@@ -37,6 +59,9 @@ namespace command_line {
     bool generate_all = false;
     bool sort = false;
     bool known_initial_root = false;
+    unsigned threads = 1;
+    bool safe = false;
+    std::vector< mpz_class > factors;
 
     void parse( cmdline::args && args ) {
         while( args.size() > 0 ) {
@@ -49,11 +74,29 @@ namespace command_line {
                 sort = true;
                 continue;
             }
+            if( arg == "--safe" ) {
+                safe = true;
+                continue;
+            }
+            if( arg == "--factor" ) {
+                mpz_class factor;
+                args >> factor;
+                factors.push_back( factor );
+                continue;
+            }
+            if( arg == "--threads" ) {
+                args >> threads;
+                continue;
+            }
             if( arg == "--root" ) {
                 args >> root;
                 known_initial_root = true;
                 continue;
             }
+            if( arg == "--stats" ) {
+                instrument::report_at_exit();
+                continue;
+            }
             if( arg == "--help" ) {
                 std::cout << "Usage: " << args.program_name() << help_message;
                 std::exit( 0 );
@@ -68,25 +111,50 @@ namespace command_line {
 
 int main( int argc, char ** argv ) {
     command_line::parse( cmdline::args(argc, argv) );
+
+    math::factor::factor_list< mpz_class > factors;
+    if( command_line::safe )
+        factors = {{2, 1}, {(command_line::prime - 1) / 2, 1}};
+    else if( !command_line::factors.empty() )
+        for( const auto & factor : command_line::factors )
+            math::factor::add_factor( factors, factor );
+    else
+        factors = math::factor::factor( mpz_class(command_line::prime - 1) );
+
     if( !command_line::known_initial_root )
-        command_line::root = math::primitive_root_modulo_p( command_line::prime );
+        command_line::root = math::primitive_root_modulo_p( command_line::prime, factors );
 
     if( command_line::root == 0 ) {
         std::cout << "No primitive roots found for " << command_line::prime;
         return 1;
     }
 
-    std::vector<mpz_class> roots = {command_line::root};
+    if( !command_line::generate_all ) {
+        std::cout << command_line::root << '\n';
+        return 0;
+    }
 
-    if( command_line::generate_all )
-        roots = math::all_primitive_roots_modulo_p(
-            command_line::prime, command_line::root
-        );
-    if( command_line::sort )
-        std::sort( roots.begin(), roots.end() );
+    std::vector<mpz_class> roots;
+    math::enumerate_primitive_roots(
+        command_line::prime,
+        command_line::root,
+        factors,
+        command_line::threads,
+        1 << 16,
+        [&]( const std::vector<mpz_class> & block ) {
+            if( command_line::sort )
+                roots.insert( roots.end(), block.begin(), block.end() );
+            else
+                for( const auto & root : block )
+                    std::cout << root << '\n';
+        }
+    );
 
-    for( const auto & root : roots )
-        std::cout << root << '\n';
+    if( command_line::sort ) {
+        std::sort( roots.begin(), roots.end() );
+        for( const auto & root : roots )
+            std::cout << root << '\n';
+    }
 
     return 0;
 }
@@ -0,0 +1,203 @@
+#ifndef PROTOCOLS_BATCH_RSA_HPP
+#define PROTOCOLS_BATCH_RSA_HPP
+
+/* Fiat's batch RSA decryption.
+ *
+ * A set of keys share the modulus n = pq,
+ * but each has its own small public exponent e_i;
+ * the exponents are pairwise coprime (for instance, the first odd primes).
+ * Given one ciphertext c_i for each key, the plaintexts c_i^(1/e_i)
+ * are computed with a single full-size exponentiation,
+ * instead of one for each ciphertext.
+ *
+ * The ciphertexts are the leaves of a binary tree.
+ * Going up, each node combines its children L and R into
+ *      e = e_L e_R,    v = v_L^e_R v_R^e_L,
+ * so that v^(1/e) = v_L^(1/e_L) v_R^(1/e_R).
+ * At the root, v^(1/e) is computed by a full exponentiation,
+ * done modulo p and q separately and combined with the CRT.
+ * Going down, each root r = v^(1/e) is split in its children's roots:
+ * with X = 0 mod e_L, X = 1 mod e_R (which exists as they are coprime),
+ *      r_R = r^X / (v_L^(X/e_L) v_R^((X-1)/e_R)),    r_L = r / r_R.
+ * Every exponent but the one at the root is a product of small exponents,
+ * so the tree costs little compared to a full exponentiation;
+ * the two powers of each step share their squarings (math::multi_pow_mod).
+ */
+
+#include <stdexcept>
+#include <vector>
+#include <gmpxx.h>
+#include "instrument/instrument.hpp"
+#include "math/algo.hpp"
+#include "math/prime_list/list.h"
+#include "protocols/rsa.hpp"
+
+namespace rsa {
+
+    /* Returns the first count odd primes: 3, 5, 7, 11, ...
+     * These are suitable exponents for batch_private_key.
+     */
+    inline std::vector< mpz_class > batch_exponents( std::size_t count );
+
+    template< typename T >
+    class batch_private_key {
+    public:
+        /* Key for decrypting batches of ciphertexts under the exponents,
+         * with the modulus n = pq.
+         * The exponents must be pairwise coprime,
+         * and coprime with both p-1 and q-1.
+         */
+        batch_private_key( T p, T q, std::vector< T > exponents );
+
+        const T & modulus() const { return n; }
+        std::size_t size() const { return e.size(); }
+
+        // Public key corresponding to the i-th exponent.
+        public_key<T> public_key_at( std::size_t i ) const;
+
+        /* Decrypts ciphertexts[i] with the i-th key, for every i.
+         * There must be exactly one ciphertext for each exponent,
+         * and every ciphertext must be coprime with the modulus
+         * (which fails with negligible probability for real ciphertexts).
+         */
+        std::vector< T > decrypt( const std::vector< T > & ciphertexts ) const;
+
+        /* Decrypts a single ciphertext with the i-th key,
+         * using the CRT, but without batching.
+         */
+        T decrypt_one( const T & ciphertext, std::size_t i ) const;
+
+    private:
+        T p, q, n;
+        T q_inverse; // q^-1 mod p
+        std::vector< T > e;
+
+        /* exponents[k][j] is the product of the leaf exponents under
+         * the j-th node of level k; level 0 are the leaves.
+         * split[k][j] is the X of the j-th node of level k+1, if it has two children.
+         */
+        std::vector< std::vector< T > > exponents;
+        std::vector< std::vector< T > > split;
+        T root_p, root_q; // Inverses of the root exponent mod p-1 and q-1
+
+        // Computes v^d mod n, knowing d mod p-1 and d mod q-1.
+        T crt_pow( const T & v, const T & d_p, const T & d_q ) const;
+    };
+
+// Implementation
+
+    std::vector< mpz_class > batch_exponents( std::size_t count ) {
+        std::vector< mpz_class > exponents;
+        for( std::size_t i = 1; i <= count; i++ )
+            exponents.push_back( math::prime_list::p[i] );
+        return exponents;
+    }
+
+    template< typename T >
+    batch_private_key<T>::batch_private_key( T p, T q, std::vector< T > exponents ) :
+        p( p ), q( q ), n( p * q ),
+        q_inverse( math::modular_inverse( T(q % p), p ) ),
+        e( std::move(exponents) )
+    {
+        if( e.empty() )
+            throw std::invalid_argument( "There must be at least one exponent." );
+
+        this->exponents.push_back( e );
+        while( this->exponents.back().size() > 1 ) {
+            const auto & below = this->exponents.back();
+            std::vector< T > level, xs;
+            for( std::size_t j = 0; j + 1 < below.size(); j += 2 ) {
+                const T & e_L = below[j], & e_R = below[j+1];
+                if( math::gcd( e_L, e_R ) != 1 )
+                    throw std::invalid_argument( "The exponents must be pairwise coprime." );
+                // X = e_L * (e_L^-1 mod e_R), so X = 0 mod e_L and X = 1 mod e_R.
+                xs.push_back( e_L * math::modular_inverse( T(e_L % e_R), e_R ) );
+                level.push_back( e_L * e_R );
+            }
+            if( below.size() % 2 == 1 )
+                level.push_back( below.back() );
+            split.push_back( xs );
+            this->exponents.push_back( level );
+        }
+
+        const T & root = this->exponents.back()[0];
+        if( math::gcd( root, T(p-1) ) != 1 || math::gcd( root, T(q-1) ) != 1 )
+            throw std::invalid_argument( "The exponents must be coprime with p-1 and q-1." );
+        root_p = math::modular_inverse( T(root % (p-1)), T(p-1) );
+        root_q = math::modular_inverse( T(root % (q-1)), T(q-1) );
+    }
+
+    template< typename T >
+    public_key<T> batch_private_key<T>::public_key_at( std::size_t i ) const {
+        return build_public_key( p, q, e[i] );
+    }
+
+    template< typename T >
+    T batch_private_key<T>::crt_pow( const T & v, const T & d_p, const T & d_q ) const {
+        T m_p = math::pow_mod( T(v % p), d_p, p );
+        T m_q = math::pow_mod( T(v % q), d_q, q );
+        T h = (m_p - m_q) % p;
+        if( h < 0 )
+            h += p;
+        return m_q + q * (h * q_inverse % p);
+    }
+
+    template< typename T >
+    T batch_private_key<T>::decrypt_one( const T & ciphertext, std::size_t i ) const {
+        instrument::count( instrument::counter::rsa_operations );
+        T d_p = math::modular_inverse( T(e[i] % (p-1)), T(p-1) );
+        T d_q = math::modular_inverse( T(e[i] % (q-1)), T(q-1) );
+        return crt_pow( ciphertext, d_p, d_q );
+    }
+
+    template< typename T >
+    std::vector< T > batch_private_key<T>::decrypt( const std::vector< T > & ciphertexts ) const {
+        if( ciphertexts.size() != e.size() )
+            throw std::invalid_argument( "There must be one ciphertext for each exponent." );
+        instrument::count( instrument::counter::rsa_operations, ciphertexts.size() );
+
+        // Percolate up.
+        std::vector< std::vector< T > > values{ ciphertexts };
+        for( std::size_t k = 0; k + 1 < exponents.size(); k++ ) {
+            const auto & below = values[k];
+            const auto & e_below = exponents[k];
+            std::vector< T > level;
+            for( std::size_t j = 0; j + 1 < below.size(); j += 2 )
+                level.push_back( math::multi_pow_mod< T >(
+                    {{below[j], e_below[j+1]}, {below[j+1], e_below[j]}}, n ) );
+            if( below.size() % 2 == 1 )
+                level.push_back( below.back() );
+            values.push_back( level );
+        }
+
+        // The only full-size exponentiation.
+        std::vector< T > roots{ crt_pow( values.back()[0], root_p, root_q ) };
+
+        // Percolate down.
+        for( std::size_t k = exponents.size() - 1; k > 0; k-- ) {
+            const auto & below = values[k-1];
+            const auto & e_below = exponents[k-1];
+            std::vector< T > level;
+            for( std::size_t j = 0; j < roots.size(); j++ ) {
+                if( 2*j + 1 == below.size() ) {
+                    level.push_back( roots[j] ); // Carried up unchanged
+                    continue;
+                }
+                const T & X = split[k-1][j];
+                const T & e_L = e_below[2*j], & e_R = e_below[2*j+1];
+                T denominator = math::multi_pow_mod< T >(
+                    {{below[2*j], T(X / e_L)}, {below[2*j+1], T((X - 1) / e_R)}}, n );
+                T r_R = math::pow_mod( roots[j], X, n )
+                    * math::modular_inverse( denominator, n ) % n;
+                T r_L = roots[j] * math::modular_inverse( r_R, n ) % n;
+                level.push_back( r_L );
+                level.push_back( r_R );
+            }
+            roots = std::move( level );
+        }
+        return roots;
+    }
+
+} // namespace rsa
+
+#endif // PROTOCOLS_BATCH_RSA_HPP
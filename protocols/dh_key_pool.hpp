@@ -0,0 +1,236 @@
+#ifndef PROTOCOLS_DH_KEY_POOL_HPP
+#define PROTOCOLS_DH_KEY_POOL_HPP
+
+/* Pool of precomputed Diffie-Hellman key pairs.
+ *
+ * Half of the cost of a handshake is generating the private number
+ * and raising the generator to it, which does not depend on the partner.
+ * The pool moves that work off the critical path:
+ * background threads keep a parallel::bounded_queue of ready
+ * (private, public) pairs full, and a handshake takes one in O(1),
+ * without locks. If the pool is empty, the pair is computed on the spot.
+ *
+ * The refill threads lower their scheduling priority,
+ * so that they only use processors that the handshakes leave idle.
+ * They sleep while the queue is full; taking a pair wakes one of them.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <gmpxx.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "parallel/bounded_queue.hpp"
+#include "protocols/diffie_hellman.hpp"
+#include "random/xorshift.hpp"
+
+namespace protocol {
+
+    struct dh_key_pair {
+        mpz_class private_number;
+        mpz_class public_number;
+    };
+
+    /* Counters of a dh_key_pool, for sizing it.
+     */
+    struct dh_key_pool_stats {
+        std::uint64_t generated = 0;   // Pairs computed by the refill threads
+        std::uint64_t hits = 0;        // Pairs taken from the pool
+        std::uint64_t misses = 0;      // Pairs computed on the spot because the pool was empty
+        std::size_t ready = 0;         // Pairs in the pool now
+        std::size_t lowest_ready = 0;  // Fewest pairs seen in the pool after a take
+        std::size_t capacity = 0;
+        double seconds = 0;            // Since the pool was created
+
+        // Pairs generated per second by the refill threads.
+        double refill_rate() const {
+            return seconds > 0 ? generated / seconds : 0;
+        }
+
+        // Fraction of the requests served by the pool.
+        double hit_rate() const {
+            return hits + misses > 0 ? double(hits) / (hits + misses) : 0;
+        }
+
+        // Fraction of the pool that is filled.
+        double occupancy() const {
+            return capacity > 0 ? double(ready) / capacity : 0;
+        }
+    };
+
+    class dh_key_pool {
+    public:
+        /* Pool of key pairs for diffie_hellman<>( prime, generator, subgroup_order ).
+         * capacity is rounded up to a power of two.
+         * threads is the number of refill threads; with 0 threads,
+         * the pool is never filled and every take is a miss.
+         * The RNG seeds the generators of the refill threads.
+         */
+        template< typename RNG >
+        dh_key_pool(
+            mpz_class prime,
+            mpz_class generator,
+            mpz_class subgroup_order,
+            std::size_t capacity,
+            unsigned threads,
+            RNG & rng
+        );
+
+        // Stops the refill threads.
+        ~dh_key_pool();
+
+        dh_key_pool( const dh_key_pool & ) = delete;
+        dh_key_pool & operator=( const dh_key_pool & ) = delete;
+
+        /* Takes a pair from the pool, if there is one.
+         * Lock-free; may be called from any thread.
+         */
+        bool try_take( dh_key_pair & );
+
+        /* Gives dh a key pair from the pool,
+         * or generates its private number with the RNG if the pool is empty.
+         * dh must use the same group as the pool.
+         */
+        template< typename RNG >
+        void prepare( diffie_hellman<> & dh, RNG & rng );
+
+        dh_key_pool_stats stats() const;
+
+    private:
+        mpz_class prime, generator, subgroup_order;
+        parallel::bounded_queue< dh_key_pair > queue;
+        std::chrono::steady_clock::time_point created;
+
+        std::atomic< bool > stopping{ false };
+        std::mutex mutex;
+        std::condition_variable not_full;
+        std::vector< std::thread > workers;
+
+        std::atomic< std::uint64_t > generated{ 0 }, hits{ 0 }, misses{ 0 };
+        std::atomic< std::size_t > lowest_ready;
+
+        template< typename RNG >
+        dh_key_pair generate( RNG & rng ) const;
+
+        void refill( rng::xorshift rng );
+    };
+
+// Implementation
+
+    template< typename RNG >
+    dh_key_pool::dh_key_pool(
+        mpz_class prime,
+        mpz_class generator,
+        mpz_class subgroup_order,
+        std::size_t capacity,
+        unsigned threads,
+        RNG & rng
+    ) :
+        prime( prime ),
+        generator( generator ),
+        subgroup_order( subgroup_order ),
+        queue( capacity ),
+        created( std::chrono::steady_clock::now() ),
+        lowest_ready( queue.capacity() )
+    {
+        for( unsigned t = 0; t < threads; t++ )
+            workers.emplace_back( &dh_key_pool::refill, this,
+                rng::xorshift( rng(), rng(), rng(), rng() ) );
+    }
+
+    inline dh_key_pool::~dh_key_pool() {
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+            stopping = true;
+        }
+        not_full.notify_all();
+        for( auto & worker : workers )
+            worker.join();
+    }
+
+    template< typename RNG >
+    dh_key_pair dh_key_pool::generate( RNG & rng ) const {
+        diffie_hellman<> dh( prime, generator, subgroup_order );
+        dh.generate_private_number( rng );
+        return { dh.get_private_number(), dh.get_public_number() };
+    }
+
+    inline void dh_key_pool::refill( rng::xorshift rng ) {
+        // Linux accepts thread ids in setpriority; failure is harmless.
+        setpriority( PRIO_PROCESS, syscall( SYS_gettid ), 19 );
+
+        dh_key_pair pair;
+        bool pending = false; // pair was generated, but the queue was full
+        while( true ) {
+            {
+                std::unique_lock< std::mutex > lock( mutex );
+                /* A take that happens between the check and the wait
+                 * may not wake this thread, so the wait is bounded.
+                 */
+                not_full.wait_for( lock, std::chrono::milliseconds( 10 ), [this]() {
+                    return stopping || queue.size() < queue.capacity();
+                });
+                if( stopping )
+                    return;
+                if( queue.size() >= queue.capacity() )
+                    continue;
+            }
+
+            if( !pending ) {
+                pair = generate( rng );
+                generated++;
+            }
+            // Another refill thread may have taken the last free cell.
+            pending = !queue.try_push( std::move(pair) );
+        }
+    }
+
+    inline bool dh_key_pool::try_take( dh_key_pair & pair ) {
+        if( !queue.try_pop( pair ) ) {
+            misses++;
+            lowest_ready = 0;
+            return false;
+        }
+        hits++;
+        std::size_t ready = queue.size();
+        std::size_t lowest = lowest_ready.load( std::memory_order_relaxed );
+        while( ready < lowest && !lowest_ready.compare_exchange_weak( lowest, ready ) )
+            ;
+        if( !workers.empty() )
+            not_full.notify_one();
+        return true;
+    }
+
+    template< typename RNG >
+    void dh_key_pool::prepare( diffie_hellman<> & dh, RNG & rng ) {
+        dh_key_pair pair;
+        if( try_take( pair ) )
+            dh.use_key_pair( std::move(pair.private_number), std::move(pair.public_number) );
+        else
+            dh.generate_private_number( rng );
+    }
+
+    inline dh_key_pool_stats dh_key_pool::stats() const {
+        dh_key_pool_stats s;
+        s.generated = generated;
+        s.hits = hits;
+        s.misses = misses;
+        s.ready = queue.size();
+        s.lowest_ready = lowest_ready;
+        s.capacity = queue.capacity();
+        s.seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - created
+            ).count();
+        return s;
+    }
+
+} // namespace protocol
+
+#endif // PROTOCOLS_DH_KEY_POOL_HPP
@@ -0,0 +1,268 @@
+#ifndef PROTOCOLS_DH_LOAD_HPP
+#define PROTOCOLS_DH_LOAD_HPP
+
+/* Clients of the Diffie-Hellman service of protocols/dh_service.hpp.
+ *
+ * exchange is a plain blocking client for a single key exchange.
+ *
+ * generate_load keeps a fixed number of sessions open at once,
+ * from a single thread, with epoll: each session connects,
+ * sends a public number, waits for the answer and disconnects;
+ * then the next session takes its place, until the requested number
+ * of handshakes is reached. The latency of each handshake is measured
+ * from the first connection attempt to the arrival of the answer.
+ *
+ * To keep the load generator from becoming the bottleneck,
+ * it sends public numbers from a small set of precomputed key pairs
+ * and does not compute the common secrets; the answers are only validated.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gmpxx.h>
+#include <sys/epoll.h>
+#include "net/socket.hpp"
+#include "protocols/dh_service.hpp"
+#include "protocols/diffie_hellman.hpp"
+
+namespace protocol {
+
+    /* Does a single key exchange with the server, over a new connection.
+     * dh must already have generated its private number;
+     * on return, its common secret is set.
+     * Throws std::runtime_error if the server does not answer properly.
+     */
+    inline void exchange(
+        const net::endpoint &,
+        diffie_hellman<> & dh,
+        const mpz_class & prime
+    );
+
+    struct load_options {
+        std::size_t sessions = 1000;    // Sessions open at once
+        std::size_t handshakes = 10000; // Total number of handshakes
+        std::size_t keys = 16;          // Distinct precomputed key pairs
+        mpz_class subgroup_order = 0;   // If not 0, the generator's order
+    };
+
+    struct load_stats {
+        std::size_t handshakes = 0; // Successful handshakes
+        std::size_t failures = 0;
+        double seconds = 0;
+        std::vector< double > latencies; // In seconds, sorted
+
+        double per_second() const {
+            return seconds > 0 ? handshakes / seconds : 0;
+        }
+
+        /* Latency below which lie p percent of the handshakes
+         * (nearest rank); 0 if there were no successful handshakes.
+         */
+        double percentile( double p ) const;
+    };
+
+    /* Runs the handshakes described in options against the server.
+     * The RNG generates the precomputed key pairs.
+     */
+    template< typename RNG >
+    load_stats generate_load(
+        const net::endpoint &,
+        const mpz_class & prime,
+        const mpz_class & primitive_root,
+        const load_options &,
+        RNG & rng
+    );
+
+// Implementation
+
+    void exchange(
+        const net::endpoint & e,
+        diffie_hellman<> & dh,
+        const mpz_class & prime
+    ) {
+        int fd = net::connect_to( e );
+        std::string line = encode_public_number( dh.get_public_number() );
+        std::string answer;
+        bool ok = send( fd, line.data(), line.size(), MSG_NOSIGNAL ) == (ssize_t) line.size();
+        char buffer[1024];
+        while( ok && answer.find( '\n' ) == std::string::npos ) {
+            ssize_t n = read( fd, buffer, sizeof buffer );
+            if( n <= 0 )
+                ok = false;
+            else
+                answer.append( buffer, n );
+        }
+        close( fd );
+
+        mpz_class partner;
+        if( !ok || !decode_public_number( answer.substr( 0, answer.find( '\n' ) ), prime, partner ) )
+            throw std::runtime_error( "Invalid answer from " + net::to_string( e ) );
+        dh.set_partner_public_number( partner );
+    }
+
+    double load_stats::percentile( double p ) const {
+        if( latencies.empty() )
+            return 0;
+        std::size_t rank = std::ceil( p / 100 * latencies.size() );
+        return latencies[rank == 0 ? 0 : std::min( rank, latencies.size() ) - 1];
+    }
+
+    template< typename RNG >
+    load_stats generate_load(
+        const net::endpoint & e,
+        const mpz_class & prime,
+        const mpz_class & primitive_root,
+        const load_options & options,
+        RNG & rng
+    ) {
+        using clock = std::chrono::steady_clock;
+
+        std::vector< std::string > lines;
+        for( std::size_t i = 0; i < std::max< std::size_t >( options.keys, 1 ); i++ ) {
+            diffie_hellman<> dh( prime, primitive_root, options.subgroup_order );
+            dh.generate_private_number( rng );
+            lines.push_back( encode_public_number( dh.get_public_number() ) );
+        }
+
+        struct session {
+            int fd = -1;
+            bool connecting = false;
+            clock::time_point start;
+            std::string output, input;
+        };
+        std::vector< session > sessions( std::min( options.sessions, options.handshakes ) );
+        std::deque< std::size_t > waiting; // Sessions whose connection must be retried
+
+        int epoll = epoll_create1( EPOLL_CLOEXEC );
+        if( epoll < 0 )
+            throw std::system_error( errno, std::system_category(), "epoll" );
+
+        load_stats stats;
+        std::size_t started = 0, finished = 0;
+
+        auto watch = [&]( std::size_t s, int op ) {
+            epoll_event ev{};
+            ev.events = sessions[s].output.empty() ? EPOLLIN : EPOLLOUT;
+            ev.data.u64 = s;
+            epoll_ctl( epoll, op, sessions[s].fd, &ev );
+        };
+
+        /* Tries to connect session s. If the server's backlog is full,
+         * the session waits for a retry, keeping its start time.
+         * Returns false if the connection failed.
+         */
+        auto connect_session = [&]( std::size_t s ) {
+            session & ses = sessions[s];
+            ses.fd = net::start_connect( e, ses.connecting );
+            if( ses.fd < 0 ) {
+                if( errno == EAGAIN ) {
+                    waiting.push_back( s );
+                    return true;
+                }
+                stats.failures++;
+                finished++;
+                return false;
+            }
+            watch( s, EPOLL_CTL_ADD );
+            return true;
+        };
+
+        // Starts the next handshake in session s, if there is one left.
+        auto start = [&]( std::size_t s ) {
+            while( started < options.handshakes ) {
+                session & ses = sessions[s];
+                ses.start = clock::now();
+                ses.output = lines[started % lines.size()];
+                ses.input.clear();
+                started++;
+                if( connect_session( s ) )
+                    return;
+            }
+        };
+
+        auto finish = [&]( std::size_t s, bool ok ) {
+            session & ses = sessions[s];
+            close( ses.fd );
+            ses.fd = -1;
+            finished++;
+            mpz_class answer;
+            if( ok && decode_public_number( ses.input.substr( 0, ses.input.find( '\n' ) ), prime, answer ) ) {
+                stats.handshakes++;
+                stats.latencies.push_back(
+                    std::chrono::duration<double>( clock::now() - ses.start ).count() );
+            }
+            else
+                stats.failures++;
+            start( s );
+        };
+
+        auto begin = clock::now();
+        for( std::size_t s = 0; s < sessions.size(); s++ )
+            start( s );
+
+        std::vector< epoll_event > events( 256 );
+        char buffer[4096];
+        while( finished < options.handshakes ) {
+            int n = epoll_wait( epoll, events.data(), events.size(), waiting.empty() ? -1 : 1 );
+            if( n < 0 && errno != EINTR ) {
+                close( epoll );
+                throw std::system_error( errno, std::system_category(), "epoll_wait" );
+            }
+            for( int i = 0; i < n; i++ ) {
+                std::size_t s = events[i].data.u64;
+                session & ses = sessions[s];
+                if( ses.connecting ) {
+                    int error = 0;
+                    socklen_t length = sizeof error;
+                    getsockopt( ses.fd, SOL_SOCKET, SO_ERROR, &error, &length );
+                    if( error != 0 ) {
+                        finish( s, false );
+                        continue;
+                    }
+                    ses.connecting = false;
+                }
+                if( !ses.output.empty() ) {
+                    ssize_t sent = send( ses.fd, ses.output.data(), ses.output.size(), MSG_NOSIGNAL );
+                    if( sent < 0 && errno != EAGAIN ) {
+                        finish( s, false );
+                        continue;
+                    }
+                    if( sent > 0 )
+                        ses.output.erase( 0, sent );
+                    if( ses.output.empty() )
+                        watch( s, EPOLL_CTL_MOD );
+                    continue;
+                }
+                ssize_t received = read( ses.fd, buffer, sizeof buffer );
+                if( received > 0 ) {
+                    ses.input.append( buffer, received );
+                    if( ses.input.find( '\n' ) != std::string::npos )
+                        finish( s, true );
+                }
+                else if( received == 0 || errno != EAGAIN )
+                    finish( s, false );
+            }
+
+            for( std::size_t pending = waiting.size(); pending > 0; pending-- ) {
+                std::size_t s = waiting.front();
+                waiting.pop_front();
+                if( !connect_session( s ) )
+                    start( s );
+            }
+        }
+        stats.seconds = std::chrono::duration<double>( clock::now() - begin ).count();
+        close( epoll );
+
+        std::sort( stats.latencies.begin(), stats.latencies.end() );
+        return stats;
+    }
+
+} // namespace protocol
+
+#endif // PROTOCOLS_DH_LOAD_HPP
@@ -0,0 +1,462 @@
+#ifndef PROTOCOLS_DH_SERVICE_HPP
+#define PROTOCOLS_DH_SERVICE_HPP
+
+/* Diffie-Hellman key exchange service for many concurrent clients.
+ *
+ * The wire protocol is line-based: the client sends its public number
+ * as a line of hexadecimal digits, and the server answers with its own
+ * public number in the same format. Each line sent by the client
+ * starts a new exchange, with a fresh diffie_hellman object;
+ * the client may close the connection after the first answer,
+ * or keep it for further exchanges.
+ * Public numbers outside [2, p-2], and lines longer than any public number,
+ * make the server close the connection.
+ * If the group has a subgroup of prime order q, the server's private numbers
+ * are drawn below q, and the clients' public numbers must lie in the subgroup.
+ *
+ * The server is a single event loop over epoll that only moves bytes;
+ * the exponentiations are done by a pool of worker threads,
+ * fed through a parallel::channel. Finished exchanges are passed back
+ * to the event loop through another channel, and an eventfd wakes it up.
+ * Optionally, the workers take their key pairs from a dh_key_pool,
+ * leaving a single exponentiation per exchange.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <gmpxx.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "instrument/instrument.hpp"
+#include "net/socket.hpp"
+#include "parallel/channel.hpp"
+#include "parallel/parallel_for.hpp"
+#include "protocols/dh_key_pool.hpp"
+#include "protocols/diffie_hellman.hpp"
+#include "random/xorshift.hpp"
+
+namespace protocol {
+
+    // Public number as sent on the wire, including the line break.
+    inline std::string encode_public_number( const mpz_class & n );
+
+    /* Parses a line (without the line break) as a public number modulo prime.
+     * Returns false if the line is not hexadecimal or the number
+     * is outside [2, prime-2].
+     */
+    inline bool decode_public_number(
+        const std::string & line,
+        const mpz_class & prime,
+        mpz_class & n
+    );
+
+    /* Counters of a dh_server; they may be read while the server runs.
+     */
+    struct dh_server_stats {
+        std::uint64_t connections = 0;      // Accepted connections
+        std::uint64_t exchanges = 0;        // Answers queued to the clients
+        std::uint64_t rejected = 0;         // Connections closed due to invalid input
+        std::uint64_t peak_connections = 0; // Most connections open at once
+    };
+
+    class dh_server {
+    public:
+        /* Server for exchanges modulo prime, with the given primitive root.
+         * threads is the number of workers that compute the exchanges.
+         * If subgroup_order is not 0, primitive_root is instead
+         * a generator of the subgroup of that order.
+         */
+        dh_server(
+            mpz_class prime,
+            mpz_class primitive_root,
+            unsigned threads = parallel::default_threads(),
+            mpz_class subgroup_order = 0
+        );
+        ~dh_server();
+
+        dh_server( const dh_server & ) = delete;
+        dh_server & operator=( const dh_server & ) = delete;
+
+        /* Starts listening on the endpoint.
+         * Must be called before run.
+         */
+        void listen( const net::endpoint & );
+
+        /* Makes the workers take their key pairs from the pool,
+         * which must use the same group and outlive run.
+         * Must be called before run.
+         */
+        void use_key_pool( dh_key_pool * pool ) {
+            this->pool = pool;
+        }
+
+        /* Serves clients until stop is called.
+         * The RNG seeds the generators of the worker threads.
+         * On return, every connection is closed.
+         */
+        template< typename RNG >
+        void run( RNG & rng );
+
+        /* Makes run return as soon as possible.
+         * May be called from any thread, and from signal handlers.
+         */
+        void stop();
+
+        dh_server_stats stats() const;
+
+        /* If set, called by the worker threads after each exchange
+         * with the client's public number and the common secret.
+         * It must be thread-safe.
+         */
+        std::function< void(const mpz_class &, const mpz_class &) > on_exchange;
+
+    private:
+        struct connection {
+            int fd;
+            std::uint64_t id;
+            std::string input, output;
+            bool busy = false; // An exchange is being computed by the workers
+            bool eof = false;  // The client will send nothing more
+        };
+
+        struct job {
+            int fd;
+            std::uint64_t id;
+            mpz_class partner;
+        };
+
+        struct result {
+            int fd;
+            std::uint64_t id;
+            std::string reply; // Empty if the client's number is not in the subgroup
+        };
+
+        mpz_class prime, primitive_root, subgroup_order;
+        unsigned threads;
+        dh_key_pool * pool = nullptr;
+        std::size_t max_line;
+
+        net::endpoint address;
+        int listener = -1, epoll = -1, wakeup = -1;
+        std::atomic< bool > stopping{ false };
+        std::atomic< bool > wakeup_pending{ false };
+
+        std::unordered_map< int, connection > connections;
+        std::uint64_t next_id = 0;
+        parallel::channel< job > jobs;
+        parallel::channel< result > results;
+
+        std::atomic< std::uint64_t > accepted{ 0 }, exchanges{ 0 }, rejected{ 0 }, peak{ 0 };
+
+        void wake();
+        void accept_all();
+        void drain_results();
+        void handle( connection &, std::uint32_t events );
+
+        // The functions below return false if they closed the connection.
+        bool receive( connection & );
+        bool flush( connection & );
+        bool process( connection & );
+        void update_interest( connection & );
+        void close_connection( connection & );
+    };
+
+// Implementation
+
+    std::string encode_public_number( const mpz_class & n ) {
+        return n.get_str( 16 ) + '\n';
+    }
+
+    bool decode_public_number(
+        const std::string & line,
+        const mpz_class & prime,
+        mpz_class & n
+    ) {
+        if( line.empty() || line.find_first_not_of( "0123456789abcdefABCDEF" ) != std::string::npos )
+            return false;
+        if( n.set_str( line, 16 ) != 0 )
+            return false;
+        return n >= 2 && n <= prime - 2;
+    }
+
+    inline dh_server::dh_server(
+        mpz_class prime,
+        mpz_class primitive_root,
+        unsigned threads,
+        mpz_class subgroup_order
+    ) :
+        prime( prime ),
+        primitive_root( primitive_root ),
+        subgroup_order( subgroup_order ),
+        threads( threads == 0 ? 1 : threads ),
+        max_line( mpz_sizeinbase( prime.get_mpz_t(), 16 ) + 1 )
+    {
+        epoll = epoll_create1( EPOLL_CLOEXEC );
+        wakeup = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+        if( epoll < 0 || wakeup < 0 )
+            throw std::system_error( errno, std::system_category(), "epoll" );
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = wakeup;
+        epoll_ctl( epoll, EPOLL_CTL_ADD, wakeup, &ev );
+    }
+
+    inline dh_server::~dh_server() {
+        for( auto & pair : connections )
+            close( pair.first );
+        if( listener >= 0 ) {
+            close( listener );
+            if( address.unix_socket )
+                unlink( address.path.c_str() );
+        }
+        close( wakeup );
+        close( epoll );
+    }
+
+    inline void dh_server::listen( const net::endpoint & e ) {
+        address = e;
+        listener = net::listen_on( e );
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = listener;
+        epoll_ctl( epoll, EPOLL_CTL_ADD, listener, &ev );
+    }
+
+    inline void dh_server::stop() {
+        stopping = true;
+        std::uint64_t one = 1;
+        ssize_t ignored = write( wakeup, &one, sizeof one );
+        (void) ignored;
+    }
+
+    inline dh_server_stats dh_server::stats() const {
+        dh_server_stats s;
+        s.connections = accepted;
+        s.exchanges = exchanges;
+        s.rejected = rejected;
+        s.peak_connections = peak;
+        return s;
+    }
+
+    inline void dh_server::wake() {
+        // One write is enough until the event loop drains the results.
+        if( !wakeup_pending.exchange( true ) ) {
+            std::uint64_t one = 1;
+            ssize_t ignored = write( wakeup, &one, sizeof one );
+            (void) ignored;
+        }
+    }
+
+    template< typename RNG >
+    void dh_server::run( RNG & rng ) {
+        if( listener < 0 )
+            throw std::logic_error( "dh_server::run called before listen." );
+
+        std::vector< std::thread > workers;
+        for( unsigned t = 0; t < threads; t++ )
+            workers.emplace_back( [this]( rng::xorshift worker_rng ) {
+                job j;
+                while( jobs.pop( j ) && j.fd >= 0 ) {
+                    instrument::scoped_timer timer( instrument::timer::dh_exchange );
+                    diffie_hellman<> dh( prime, primitive_root, subgroup_order );
+                    if( pool )
+                        pool->prepare( dh, worker_rng );
+                    else
+                        dh.generate_private_number( worker_rng );
+                    if( !dh.set_partner_public_number( j.partner, subgroup_order != 0 ) ) {
+                        results.push( {j.fd, j.id, std::string()} );
+                        wake();
+                        continue;
+                    }
+                    if( on_exchange )
+                        on_exchange( j.partner, dh.get_common_secret() );
+                    results.push( {j.fd, j.id, encode_public_number( dh.get_public_number() )} );
+                    wake();
+                }
+            }, rng::xorshift( rng(), rng(), rng(), rng() ) );
+
+        std::vector< epoll_event > events( 256 );
+        while( !stopping ) {
+            int n = epoll_wait( epoll, events.data(), events.size(), -1 );
+            if( n < 0 ) {
+                if( errno == EINTR )
+                    continue;
+                stopping = true;
+                break;
+            }
+            for( int i = 0; i < n; i++ ) {
+                int fd = events[i].data.fd;
+                if( fd == listener )
+                    accept_all();
+                else if( fd == wakeup )
+                    drain_results();
+                else {
+                    auto it = connections.find( fd );
+                    if( it != connections.end() )
+                        handle( it->second, events[i].events );
+                }
+            }
+        }
+
+        // Pending exchanges are abandoned; a job with fd = -1 stops a worker.
+        job j;
+        while( jobs.try_pop( j ) )
+            ;
+        for( unsigned t = 0; t < threads; t++ )
+            jobs.push( {-1, 0, mpz_class()} );
+        for( auto & worker : workers )
+            worker.join();
+        result r;
+        while( results.try_pop( r ) )
+            ;
+        for( auto & pair : connections )
+            close( pair.first );
+        connections.clear();
+        stopping = false;
+        wakeup_pending = false;
+    }
+
+    inline void dh_server::accept_all() {
+        while( true ) {
+            int fd = accept4( listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC );
+            if( fd < 0 )
+                return; // EAGAIN, or out of descriptors: retried on the next event
+            connection & c = connections[fd];
+            c.fd = fd;
+            c.id = next_id++;
+            accepted++;
+            if( connections.size() > peak )
+                peak = connections.size();
+
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            epoll_ctl( epoll, EPOLL_CTL_ADD, fd, &ev );
+        }
+    }
+
+    inline void dh_server::drain_results() {
+        std::uint64_t count;
+        ssize_t ignored = read( wakeup, &count, sizeof count );
+        (void) ignored;
+        wakeup_pending = false;
+
+        result r;
+        while( results.try_pop( r ) ) {
+            auto it = connections.find( r.fd );
+            if( it == connections.end() || it->second.id != r.id )
+                continue; // The client is gone
+            connection & c = it->second;
+            if( r.reply.empty() ) {
+                rejected++;
+                close_connection( c );
+                continue;
+            }
+            c.busy = false;
+            c.output += r.reply;
+            exchanges++;
+            if( flush( c ) && process( c ) )
+                update_interest( c );
+        }
+    }
+
+    inline void dh_server::handle( connection & c, std::uint32_t events ) {
+        if( events & (EPOLLERR | EPOLLHUP) ) {
+            close_connection( c );
+            return;
+        }
+        if( (events & EPOLLIN) && !receive( c ) )
+            return;
+        if( (events & EPOLLOUT) && !flush( c ) )
+            return;
+        if( process( c ) )
+            update_interest( c );
+    }
+
+    inline bool dh_server::receive( connection & c ) {
+        char buffer[4096];
+        while( true ) {
+            ssize_t n = read( c.fd, buffer, sizeof buffer );
+            if( n > 0 ) {
+                c.input.append( buffer, n );
+                continue;
+            }
+            if( n == 0 )
+                c.eof = true;
+            else if( errno != EAGAIN && errno != EWOULDBLOCK ) {
+                close_connection( c );
+                return false;
+            }
+            return true;
+        }
+    }
+
+    inline bool dh_server::flush( connection & c ) {
+        std::size_t sent = 0;
+        while( sent < c.output.size() ) {
+            ssize_t n = send( c.fd, c.output.data() + sent, c.output.size() - sent, MSG_NOSIGNAL );
+            if( n < 0 ) {
+                if( errno == EAGAIN || errno == EWOULDBLOCK )
+                    break;
+                close_connection( c );
+                return false;
+            }
+            sent += n;
+        }
+        c.output.erase( 0, sent );
+        return true;
+    }
+
+    inline bool dh_server::process( connection & c ) {
+        if( !c.busy ) {
+            std::size_t end = c.input.find( '\n' );
+            if( end != std::string::npos ) {
+                job j{ c.fd, c.id, mpz_class() };
+                if( !decode_public_number( c.input.substr( 0, end ), prime, j.partner ) ) {
+                    rejected++;
+                    close_connection( c );
+                    return false;
+                }
+                c.input.erase( 0, end + 1 );
+                c.busy = true;
+                jobs.push( std::move(j) );
+            }
+            else if( c.input.size() > max_line ) {
+                rejected++;
+                close_connection( c );
+                return false;
+            }
+        }
+        if( c.eof && !c.busy && c.output.empty() ) {
+            close_connection( c );
+            return false;
+        }
+        return true;
+    }
+
+    inline void dh_server::update_interest( connection & c ) {
+        epoll_event ev{};
+        if( !c.eof )
+            ev.events |= EPOLLIN;
+        if( !c.output.empty() )
+            ev.events |= EPOLLOUT;
+        ev.data.fd = c.fd;
+        epoll_ctl( epoll, EPOLL_CTL_MOD, c.fd, &ev );
+    }
+
+    inline void dh_server::close_connection( connection & c ) {
+        int fd = c.fd;
+        close( fd ); // Also removes it from the epoll set
+        connections.erase( fd );
+    }
+
+} // namespace protocol
+
+#endif // PROTOCOLS_DH_SERVICE_HPP
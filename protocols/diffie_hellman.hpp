@@ -2,46 +2,81 @@
 #define PROTOCOLS_DIFFIE_HELLMAN_HPP
 
 /* Implementation of Diffie-Hellman-Merkle's key exchange protocol.
+ *
+ * The generator may be a primitive root modulo p,
+ * or generate a subgroup of prime order q (see math::generate_subgroup_prime).
+ * In the latter case, the private numbers are drawn below q,
+ * so both exponentiations have as many bits as q instead of p:
+ * with a 256-bit q in a 2048-bit group, an exchange is about 8 times faster
+ * (see bench/dh_handshake.cpp).
  */
 
+#include <utility>
 #include <gmpxx.h>
+#include "instrument/instrument.hpp"
 #include "math/algo.hpp"
 #include "random/gmp_adapter.hpp"
 
 namespace protocol {
     /* The entire protocol is encapsulated within the following class.
      * The constructor requires both a large prime number
-     * and a primitive root of that prime number.
+     * and a primitive root of that prime number;
+     * or, instead, a generator of a subgroup and the subgroup's prime order.
      * Once constructed,
      * the same object can be used for several key exchanges.
      */
     template< typename T = mpz_class >
     class diffie_hellman {
         T prime, primitive_root;
+        T subgroup_order; // 0 if primitive_root generates the whole group
         T private_number;
         T public_number;
         T partner_public_number;
         T common_secret;
 
     public:
-        diffie_hellman( T prime, T primitive_root ):
+        diffie_hellman( T prime, T primitive_root, T subgroup_order = 0 ):
             prime( prime ),
-            primitive_root( primitive_root )
+            primitive_root( primitive_root ),
+            subgroup_order( subgroup_order )
         {}
 
         /* Generate our private number,
          * that will be used to construct the common secret number.
+         * With a subgroup order q, it is uniform in [1, q-1].
          */
         template< typename RNG >
         void generate_private_number( RNG & rng );
 
+        /* Uses a private number generated beforehand,
+         * together with its public number primitive_root^private_number,
+         * instead of generating one (see protocols/dh_key_pool.hpp).
+         */
+        void use_key_pair( T private_number, T public_number );
+
+        /* Returns our private number. It must never be sent;
+         * this only serves to store key pairs for use_key_pair.
+         */
+        T get_private_number() const;
+
         /* Returns the public number that must be sent to our partner.
          */
         T get_public_number() const;
 
         /* Informs the public number of our partner.
+         *
+         * If check is true, the number is first validated:
+         * it must be in [2, p-2] and, with a subgroup order q,
+         * satisfy t^q = 1 mod p, so that it lies in the subgroup.
+         * The membership test costs one more exponentiation by q.
+         * If the number is invalid, returns false
+         * and the common secret is not changed.
          */
-        void set_partner_public_number( T t );
+        bool set_partner_public_number( T t, bool check = false );
+
+        /* Returns true if t passes the checks of set_partner_public_number.
+         */
+        bool is_valid_public_number( const T & t ) const;
 
         /* Returns the secret number which we share with our partner.
          */
@@ -53,22 +88,51 @@ namespace protocol {
     template< typename T > template< typename RNG >
     void diffie_hellman<T>::generate_private_number( RNG & rng ) {
         // TODO: Make this GMP-independent
-        int bits = mpz_sizeinbase( prime.get_mpz_t(), 2 );
-        private_number = rng::gmp_generate( rng, bits );
-        private_number %= prime;
+        if( subgroup_order != 0 ) {
+            // 64 extra bits make the bias of the reduction negligible.
+            int bits = mpz_sizeinbase( subgroup_order.get_mpz_t(), 2 ) + 64;
+            private_number = rng::gmp_generate( rng, bits ) % (subgroup_order - 1) + 1;
+        }
+        else {
+            int bits = mpz_sizeinbase( prime.get_mpz_t(), 2 );
+            private_number = rng::gmp_generate( rng, bits );
+            private_number %= prime;
+        }
 
         public_number = math::pow_mod( primitive_root, private_number, prime );
     }
 
+    template< typename T >
+    void diffie_hellman<T>::use_key_pair( T private_number, T public_number ) {
+        this->private_number = std::move( private_number );
+        this->public_number = std::move( public_number );
+    }
+
+    template< typename T >
+    T diffie_hellman<T>::get_private_number() const {
+        return private_number;
+    }
+
     template< typename T >
     T diffie_hellman<T>::get_public_number() const {
         return public_number;
     }
 
     template< typename T >
-    void diffie_hellman<T>::set_partner_public_number( T t ) {
+    bool diffie_hellman<T>::is_valid_public_number( const T & t ) const {
+        if( t < 2 || t > prime - 2 )
+            return false;
+        return subgroup_order == 0 || math::pow_mod( t, subgroup_order, prime ) == 1;
+    }
+
+    template< typename T >
+    bool diffie_hellman<T>::set_partner_public_number( T t, bool check ) {
+        if( check && !is_valid_public_number( t ) )
+            return false;
         partner_public_number = t;
         common_secret = math::pow_mod( t, private_number, prime );
+        instrument::count( instrument::counter::key_exchanges );
+        return true;
     }
 
     template< typename T >
@@ -5,9 +5,19 @@
  */
 
 #include <iostream>
+#include <utility>
+#include <gmpxx.h>
+#include "instrument/instrument.hpp"
 #include "math/algo.hpp"
+#include "math/generate_primes.hpp"
 
 namespace rsa {
+    /* Default public exponent: the prime 65537 = 2^16 + 1.
+     * It is small and has only two set bits,
+     * so encryption takes 16 squarings and one multiplication.
+     */
+    constexpr unsigned long default_public_exponent = 65537;
+
     /* This structure represents the public key of the algorithm.
      * This data may be shared with everyone.
      */
@@ -15,7 +25,10 @@ namespace rsa {
     struct public_key {
         T b, n;
 
-        // Encrypts the given number.
+        /* Encrypts the given number.
+         * If b fits in a machine word (like the default exponent),
+         * math::pow_mod_word is used.
+         */
         T encrypt( T ) const;
     };
 
@@ -53,6 +66,18 @@ namespace rsa {
     template< typename T >
     private_key<T> build_private_key( T p, T q, T b );
 
+    /* Generates the primes p and q for a key with the given number of bits,
+     * such that the public exponent e is coprime with both p-1 and q-1.
+     * e must be odd and greater than 1.
+     */
+    template< typename RNG >
+    std::pair< mpz_class, mpz_class > generate_key_primes(
+        RNG & rng,
+        int key_size,
+        const mpz_class & e,
+        int trials = 30
+    );
+
     // Implementation of template code
     template< typename T >
     public_key<T> build_public_key( T p, T q, T b ) {
@@ -64,13 +89,39 @@ namespace rsa {
         return { math::modular_inverse( b, T( (p-1) * (q-1) ) ), p * q };
     }
 
+    template< typename RNG >
+    std::pair< mpz_class, mpz_class > generate_key_primes(
+        RNG & rng,
+        int key_size,
+        const mpz_class & e,
+        int trials
+    ) {
+        auto generate = [&]( int bits ) {
+            mpz_class p;
+            do {
+                p = math::generate_prime_number( rng, bits, trials );
+            } while( math::gcd( mpz_class(p - 1), e ) != 1 );
+            return p;
+        };
+        mpz_class p = generate( key_size / 2 ), q;
+        do {
+            q = generate( (key_size + 1) / 2 );
+        } while( q == p );
+        return std::make_pair( p, q );
+    }
+
     template< typename T >
     T public_key<T>::encrypt( T x ) const {
+        instrument::count( instrument::counter::rsa_operations );
+        unsigned long e;
+        if( math::to_word( b, e ) )
+            return math::pow_mod_word( x, e, n );
         return math::pow_mod( x, b, n );
     }
 
     template< typename T >
     T private_key<T>::decrypt( T y ) const {
+        instrument::count( instrument::counter::rsa_operations );
         return math::pow_mod( y, a, n );
     }
 
@@ -0,0 +1,186 @@
+#ifndef PROTOCOLS_RSA_STREAM_HPP
+#define PROTOCOLS_RSA_STREAM_HPP
+
+/* RSA encryption of arbitrary byte streams.
+ *
+ * The input is split into blocks of block_bytes(n) bytes;
+ * only the last block may be shorter.
+ * Each block is prefixed with a byte 0x01 and read as a big-endian integer,
+ * so that leading zero bytes and the length of the last block
+ * survive the round trip: after decryption, the data
+ * is everything after the first non-zero byte, which must be 0x01.
+ * block_bytes(n) is chosen so that 0x01 followed by a full block
+ * is always smaller than n.
+ *
+ * Each ciphertext block is written as a big-endian integer
+ * of exactly cipher_bytes(n) bytes, so the ciphertext can be split
+ * into blocks again without any separators.
+ *
+ * Blocks are read and written in batches; the blocks of a batch
+ * are encrypted or decrypted in parallel.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <gmpxx.h>
+#include "parallel/parallel_for.hpp"
+#include "protocols/rsa.hpp"
+
+namespace rsa {
+
+    // Number of plaintext bytes in each full block.
+    inline std::size_t block_bytes( const mpz_class & n );
+
+    // Number of bytes of each ciphertext block.
+    inline std::size_t cipher_bytes( const mpz_class & n );
+
+    /* Encrypts the whole input stream and writes the ciphertext to out.
+     * Each batch holds blocks_per_batch blocks.
+     * Returns the number of blocks written.
+     *
+     * Throws std::invalid_argument if the modulus is too small
+     * to hold a single byte per block.
+     */
+    inline std::size_t encrypt_stream(
+        std::istream & in,
+        std::ostream & out,
+        const public_key< mpz_class > & key,
+        unsigned threads = 1,
+        std::size_t blocks_per_batch = 1024
+    );
+
+    /* Decrypts a stream produced by encrypt_stream.
+     * Returns the number of blocks read.
+     *
+     * Throws std::runtime_error if the input is not a whole number
+     * of ciphertext blocks or some block does not decrypt to a valid block
+     * (for instance, because the key is wrong).
+     */
+    inline std::size_t decrypt_stream(
+        std::istream & in,
+        std::ostream & out,
+        const private_key< mpz_class > & key,
+        unsigned threads = 1,
+        std::size_t blocks_per_batch = 1024
+    );
+
+// Implementation
+
+    std::size_t block_bytes( const mpz_class & n ) {
+        std::size_t bits = mpz_sizeinbase( n.get_mpz_t(), 2 );
+        return bits < 10 ? 0 : (bits - 2) / 8;
+    }
+
+    std::size_t cipher_bytes( const mpz_class & n ) {
+        return (mpz_sizeinbase( n.get_mpz_t(), 2 ) + 7) / 8;
+    }
+
+    // Writes n as a big-endian integer of exactly width bytes.
+    inline void export_block( unsigned char * buf, const mpz_class & n, std::size_t width ) {
+        std::size_t count = (mpz_sizeinbase( n.get_mpz_t(), 2 ) + 7) / 8;
+        std::memset( buf, 0, width - count );
+        if( n != 0 )
+            mpz_export( buf + width - count, nullptr, 1, 1, 0, 0, n.get_mpz_t() );
+    }
+
+    std::size_t encrypt_stream(
+        std::istream & in,
+        std::ostream & out,
+        const public_key< mpz_class > & key,
+        unsigned threads,
+        std::size_t blocks_per_batch
+    ) {
+        const std::size_t d = block_bytes( key.n ), w = cipher_bytes( key.n );
+        if( d == 0 )
+            throw std::invalid_argument( "The modulus is too small for byte encryption." );
+
+        std::vector< unsigned char > input( blocks_per_batch * d );
+        std::vector< unsigned char > output( blocks_per_batch * w );
+        std::size_t total = 0;
+        while( in ) {
+            in.read( (char *) input.data(), input.size() );
+            std::size_t size = in.gcount();
+            if( size == 0 )
+                break;
+            std::size_t blocks = (size + d - 1) / d;
+
+            parallel::parallel_for( 0, blocks, threads,
+                [&]( std::size_t i, unsigned ) {
+                    std::size_t length = std::min( d, size - i * d );
+                    std::vector< unsigned char > block( 1 + d );
+                    block[0] = 0x01;
+                    std::memcpy( block.data() + 1, &input[i * d], length );
+                    mpz_class m;
+                    mpz_import( m.get_mpz_t(), 1 + length, 1, 1, 0, 0, block.data() );
+                    export_block( &output[i * w], key.encrypt( m ), w );
+                }
+            );
+            out.write( (const char *) output.data(), blocks * w );
+            total += blocks;
+        }
+        return total;
+    }
+
+    std::size_t decrypt_stream(
+        std::istream & in,
+        std::ostream & out,
+        const private_key< mpz_class > & key,
+        unsigned threads,
+        std::size_t blocks_per_batch
+    ) {
+        const std::size_t d = block_bytes( key.n ), w = cipher_bytes( key.n );
+        if( d == 0 )
+            throw std::invalid_argument( "The modulus is too small for byte encryption." );
+
+        std::vector< unsigned char > input( blocks_per_batch * w );
+        std::vector< unsigned char > output( blocks_per_batch * d );
+        std::vector< std::size_t > lengths( blocks_per_batch );
+        std::size_t total = 0;
+        while( in ) {
+            in.read( (char *) input.data(), input.size() );
+            std::size_t size = in.gcount();
+            if( size == 0 )
+                break;
+            if( size % w != 0 )
+                throw std::runtime_error( "The ciphertext is truncated." );
+            std::size_t blocks = size / w;
+
+            parallel::parallel_for( 0, blocks, threads,
+                [&]( std::size_t i, unsigned ) {
+                    mpz_class c;
+                    mpz_import( c.get_mpz_t(), w, 1, 1, 0, 0, &input[i * w] );
+                    mpz_class m = key.decrypt( c );
+
+                    // m is 0x01 followed by up to d bytes.
+                    std::size_t bytes = (mpz_sizeinbase( m.get_mpz_t(), 2 ) + 7) / 8;
+                    std::vector< unsigned char > block( 1 + d );
+                    if( m == 0 || bytes > 1 + d ) {
+                        lengths[i] = -1;
+                        return;
+                    }
+                    export_block( block.data(), m, bytes );
+                    if( block[0] != 0x01 ) {
+                        lengths[i] = -1;
+                        return;
+                    }
+                    lengths[i] = bytes - 1;
+                    std::memcpy( &output[i * d], block.data() + 1, bytes - 1 );
+                }
+            );
+
+            for( std::size_t i = 0; i < blocks; i++ ) {
+                if( lengths[i] == std::size_t(-1) )
+                    throw std::runtime_error( "Invalid ciphertext block." );
+                out.write( (const char *) &output[i * d], lengths[i] );
+            }
+            total += blocks;
+        }
+        return total;
+    }
+
+} // namespace rsa
+
+#endif // PROTOCOLS_RSA_STREAM_HPP
@@ -6,7 +6,10 @@
  */
 
 #include <stdio.h>
+#include <cstdint>
+#include <vector>
 #include <gmpxx.h>
+#include "instrument/instrument.hpp"
 
 namespace rng {
     /* Returns a mpz_class with the specified number of bits,
@@ -19,6 +22,7 @@ namespace rng {
 
     template< typename RNG >
     mpz_class gmp_generate( RNG & rng, std::uint32_t number_of_bits ) {
+        instrument::count( instrument::counter::random_numbers );
         if( number_of_bits == 0 )
             return mpz_class( 0 );
 
@@ -34,16 +38,14 @@ namespace rng {
         std::uint32_t number_of_bytes = (number_of_bits + 7)/8;
         unsigned bits_last_byte = (number_of_bits - 1) % 8 + 1;
 
-        /* The buffer we will write to will be kept as static,
+        /* The buffer we will write to will be kept as thread_local,
          * so that sucessive invocations of this method does not have
-         * the memory allocation overhead. */
-        static unsigned char * buf = 0;
-        static unsigned buf_size = 0;
-        if( 4 + number_of_bytes > buf_size ) {
-            delete buf;
-            buf = new unsigned char[4 + number_of_bytes];
-            buf_size = 4 + number_of_bytes;
-        }
+         * the memory allocation overhead,
+         * and threads with their own generators do not share it. */
+        thread_local std::vector< unsigned char > buffer;
+        if( 4 + number_of_bytes > buffer.size() )
+            buffer.resize( 4 + number_of_bytes );
+        unsigned char * buf = buffer.data();
 
         // First, write the size, in guaranteed big-endian order
         std::uint32_t size = number_of_bytes;
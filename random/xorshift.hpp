@@ -13,6 +13,7 @@
 
 #include <cstdint>
 #include <chrono>
+#include "instrument/instrument.hpp"
 
 namespace rng {
 
@@ -56,6 +57,7 @@ namespace rng {
 
     template < std::uint32_t a, std::uint32_t b, std::uint32_t c >
     std::uint32_t xorshift_t< a, b, c >::operator()() {
+        instrument::count( instrument::counter::rng_words );
         std::uint32_t t = x ^ (x << a);
         x = y; y = z; z = w;
         return w = (w ^ (w >> c)) ^ (t ^ (t >> b));
@@ -23,11 +23,33 @@ namespace command_line {
 "    encrypted data written to stdout.\n"
 "    The option --private must have been set for this to work.\n"
 "\n"
+"--binary\n"
+"    In the modes --encrypt and --decrypt, read and write raw bytes\n"
+"    instead of decimal numbers; any file may be encrypted this way.\n"
+"    The plaintext is split into blocks slightly smaller than the modulus,\n"
+"    and each ciphertext block has as many bytes as the modulus\n"
+"    (see protocols/rsa_stream.hpp).\n"
+"\n"
+"--threads <N>\n"
+"    Number of threads used to encrypt or decrypt with --binary.\n"
+"    Default: number of processors.\n"
+"\n"
 "--gen-key <size>\n"
 "    Generate a key pair with the given size.\n"
 "    Both --public and --private must have been set for this to work.\n"
 "    In this mode, no data is read from stdin or written to stdout.\n"
 "\n"
+"--exponent <N>\n"
+"    Public exponent used by --gen-key; it must be odd and greater than 1.\n"
+"    The primes are chosen so that N is coprime with both p-1 and q-1.\n"
+"    If N is 0, a random prime with 2/3 of the key size is used instead,\n"
+"    which makes encryption nearly as slow as decryption.\n"
+"    Default: 65537.\n"
+"\n"
+"--stats\n"
+"    Writes the instrumentation counters to the standard error at exit\n"
+"    (see instrument/instrument.hpp; needs a build with -DINSTRUMENT).\n"
+"\n"
 "--help\n"
 "    Displays this help and quit.\n"
 ;
@@ -35,10 +57,14 @@ namespace command_line {
 
 #include <iostream>
 #include <fstream>
+#include <tuple>
 #include "cmdline/args.hpp"
+#include "instrument/instrument.hpp"
 #include "random/xorshift.hpp"
 #include "math/generate_primes.hpp"
+#include "parallel/parallel_for.hpp"
 #include "protocols/rsa.hpp"
+#include "protocols/rsa_stream.hpp"
 
 namespace command_line {
     std::string public_key_file, private_key_file;
@@ -46,6 +72,9 @@ namespace command_line {
 
     bool gen_key = false;
     int key_size;
+    mpz_class exponent = rsa::default_public_exponent;
+    bool binary = false;
+    unsigned threads = parallel::default_threads();
 
     void parse( cmdline::args && args ) {
         while( args.size() > 0 ) {
@@ -73,6 +102,26 @@ namespace command_line {
                 args.range(1) >> key_size;
                 continue;
             }
+            if( arg == "--binary" ) {
+                binary = true;
+                continue;
+            }
+            if( arg == "--threads" ) {
+                args.range( 1 ) >> threads;
+                continue;
+            }
+            if( arg == "--exponent" ) {
+                args.range( 0 ) >> exponent;
+                if( exponent != 0 && (exponent < 3 || exponent % 2 == 0) ) {
+                    std::cerr << "The exponent must be odd and greater than 1.\n";
+                    std::exit( 1 );
+                }
+                continue;
+            }
+            if( arg == "--stats" ) {
+                instrument::report_at_exit();
+                continue;
+            }
             if( arg == "--help" ) {
                 std::cout << "Usage: " << args.program_name() << help_message;
                 std::exit( 0 );
@@ -101,10 +150,15 @@ int main( int argc, char ** argv ) {
         rsa::private_key<mpz_class> private_key;
 
         rng::xorshift rng;
-        mpz_class p = math::generate_prime_number(rng, command_line::key_size/2, 30);
-        mpz_class q = math::generate_prime_number(rng, (command_line::key_size+1)/2, 30);
-        mpz_class b = math::generate_prime_number(rng, 2*command_line::key_size/3, 30);
-        // This number b is guaranteed to be coprime with both p and q.
+        mpz_class p, q, b = command_line::exponent;
+        if( b == 0 ) {
+            p = math::generate_prime_number(rng, command_line::key_size/2, 30);
+            q = math::generate_prime_number(rng, (command_line::key_size+1)/2, 30);
+            b = math::generate_prime_number(rng, 2*command_line::key_size/3, 30);
+            // This number b is guaranteed to be coprime with both p and q.
+        }
+        else
+            std::tie( p, q ) = rsa::generate_key_primes( rng, command_line::key_size, b );
         public_key = rsa::build_public_key(p, q, b);
         private_key = rsa::build_private_key(p, q, b);
 
@@ -116,6 +170,11 @@ int main( int argc, char ** argv ) {
         rsa::public_key<mpz_class> public_key;
         file >> public_key;
 
+        if( command_line::binary ) {
+            std::ios::sync_with_stdio( false );
+            rsa::encrypt_stream( std::cin, std::cout, public_key, command_line::threads );
+            return 0;
+        }
         mpz_class number;
         while( std::cin >> number )
             std::cout << public_key.encrypt(number) << '\n';
@@ -124,6 +183,17 @@ int main( int argc, char ** argv ) {
         rsa::private_key<mpz_class> private_key;
         file >> private_key;
 
+        if( command_line::binary ) {
+            std::ios::sync_with_stdio( false );
+            try {
+                rsa::decrypt_stream( std::cin, std::cout, private_key, command_line::threads );
+            }
+            catch( std::runtime_error & e ) {
+                std::cerr << "Error: " << e.what() << '\n';
+                return 1;
+            }
+            return 0;
+        }
         mpz_class number;
         while( std::cin >> number )
             std::cout << private_key.decrypt(number) << '\n';
@@ -0,0 +1,33 @@
+#include "math/batch_gcd.hpp"
+#include <gmpxx.h>
+#include <catch.hpp>
+
+TEST_CASE( "Product tree", "[math]" ) {
+    auto tree = math::product_tree<mpz_class>( {2, 3, 5, 7, 11} );
+    REQUIRE( tree.size() == 4 );
+    CHECK( tree[0] == std::vector<mpz_class>({2, 3, 5, 7, 11}) );
+    CHECK( tree[1] == std::vector<mpz_class>({6, 35, 11}) );
+    CHECK( tree[2] == std::vector<mpz_class>({210, 11}) );
+    CHECK( tree[3] == std::vector<mpz_class>({2310}) );
+
+    auto remainders = math::remainder_tree( tree );
+    for( int i = 0; i < 5; i++ )
+        CHECK( remainders[i] == 2310 % (tree[0][i] * tree[0][i]) );
+}
+
+TEST_CASE( "Batch GCD", "[math]" ) {
+    // 3*5 shares 3 with 3*7 and 5 with 5*11; 13*17 shares nothing.
+    std::vector<mpz_class> moduli = {15, 21, 55, 221};
+    std::vector<mpz_class> expected = {15, 3, 5, 1};
+    CHECK( math::batch_gcd( moduli ) == expected );
+    CHECK( math::batch_gcd( moduli, 4 ) == expected );
+
+    // Repeated moduli share every factor.
+    moduli = {77, 77, 13};
+    expected = {77, 77, 1};
+    CHECK( math::batch_gcd( moduli ) == expected );
+
+    moduli = {35};
+    expected = {1};
+    CHECK( math::batch_gcd( moduli ) == expected );
+}
@@ -0,0 +1,29 @@
+#include "protocols/batch_rsa.hpp"
+#include <catch.hpp>
+#include "random/gmp_adapter.hpp"
+#include "random/xorshift.hpp"
+
+TEST_CASE( "Batch RSA decryption", "[rsa]" ) {
+    rng::xorshift rng( 1, 2, 3, 4 );
+    for( std::size_t count : {1, 2, 5, 8} ) {
+        auto exponents = rsa::batch_exponents( count );
+        mpz_class product = 1;
+        for( const auto & e : exponents )
+            product *= e;
+        auto primes = rsa::generate_key_primes( rng, 256, product );
+        rsa::batch_private_key< mpz_class > key( primes.first, primes.second, exponents );
+        REQUIRE( key.size() == count );
+
+        std::vector< mpz_class > plaintexts, ciphertexts;
+        for( std::size_t i = 0; i < count; i++ ) {
+            plaintexts.push_back( rng::gmp_generate( rng, 200 ) );
+            ciphertexts.push_back( key.public_key_at( i ).encrypt( plaintexts.back() ) );
+            CHECK( key.decrypt_one( ciphertexts.back(), i ) == plaintexts.back() );
+        }
+        CHECK( key.decrypt( ciphertexts ) == plaintexts );
+    }
+
+    auto primes = rsa::generate_key_primes( rng, 256, mpz_class(3 * 5 * 7) );
+    CHECK_THROWS_AS( rsa::batch_private_key< mpz_class >( primes.first, primes.second,
+        {mpz_class(3), mpz_class(9)} ), std::invalid_argument );
+}
@@ -0,0 +1,51 @@
+#include "bench/bench.hpp"
+#include <catch.hpp>
+#include <sstream>
+
+TEST_CASE( "Benchmark results survive the JSON round trip", "[bench]" ) {
+    bench::result a, b;
+    a.name = "pow_mod/2048";
+    a.samples = {1e-3, 2e-3, 3e-3, 4e-3, 5e-3};
+    b.name = "name with \"quotes\"";
+    b.samples = {0.5};
+    CHECK( a.median() == 3e-3 );
+    CHECK( a.percentile( 10 ) == 1e-3 );
+    CHECK( a.percentile( 90 ) == 5e-3 );
+    CHECK( a.mean() == Approx( 3e-3 ) );
+
+    std::stringstream json;
+    bench::write_json( json, {a, b} );
+    auto list = bench::read_json( json );
+    REQUIRE( list.size() == 2 );
+    CHECK( list[0].name == a.name );
+    CHECK( list[0].median == Approx( 3e-3 ) );
+    CHECK( list[0].p90 == Approx( 5e-3 ) );
+    CHECK( list[1].name == b.name );
+    CHECK( list[1].p10 == Approx( 0.5 ) );
+
+    std::stringstream garbage( "not json" );
+    CHECK( bench::read_json( garbage ).empty() );
+}
+
+TEST_CASE( "Benchmark comparison flags only clear slowdowns", "[bench]" ) {
+    std::vector< bench::summary > old_run = {
+        {"slower", 1.0, 0.9, 1.1},
+        {"noisy", 1.0, 0.5, 1.5},
+        {"faster", 1.0, 0.9, 1.1},
+        {"removed", 1.0, 0.9, 1.1},
+    };
+    std::vector< bench::summary > new_run = {
+        {"slower", 1.5, 1.4, 1.6},
+        {"noisy", 1.2, 1.1, 1.3},
+        {"faster", 0.5, 0.4, 0.6},
+        {"added", 1.0, 0.9, 1.1},
+    };
+    auto list = bench::compare( old_run, new_run, 0.05 );
+    REQUIRE( list.size() == 3 );
+    CHECK( list[0].name == "slower" );
+    CHECK( list[0].change == Approx( 0.5 ) );
+    CHECK( list[0].regression );
+    CHECK_FALSE( list[1].regression ); // The ranges overlap
+    CHECK_FALSE( list[2].regression );
+    CHECK( list[2].change == Approx( -0.5 ) );
+}
@@ -0,0 +1,63 @@
+#include "parallel/bounded_queue.hpp"
+#include <catch.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE( "parallel::bounded_queue in a single thread", "[parallel]" ) {
+    parallel::bounded_queue< int > queue( 5 );
+    CHECK( queue.capacity() == 8 );
+    CHECK( queue.size() == 0 );
+
+    int value;
+    CHECK_FALSE( queue.try_pop( value ) );
+    for( int lap = 0; lap < 3; lap++ ) {
+        for( int i = 0; i < 8; i++ )
+            CHECK( queue.try_push( lap * 10 + i ) );
+        CHECK( queue.size() == 8 );
+        int extra = 99;
+        CHECK_FALSE( queue.try_push( std::move(extra) ) );
+        CHECK( extra == 99 );
+        for( int i = 0; i < 8; i++ ) {
+            REQUIRE( queue.try_pop( value ) );
+            CHECK( value == lap * 10 + i );
+        }
+        CHECK_FALSE( queue.try_pop( value ) );
+    }
+}
+
+TEST_CASE( "parallel::bounded_queue with several producers and consumers", "[parallel]" ) {
+    parallel::bounded_queue< long > queue( 16 );
+    const long per_producer = 20000;
+    const int producers = 3, consumers = 3;
+    std::atomic< long > sum{ 0 }, popped{ 0 };
+
+    std::vector< std::thread > threads;
+    for( int p = 0; p < producers; p++ )
+        threads.emplace_back( [&, p]() {
+            for( long i = 1; i <= per_producer; i++ ) {
+                long value = p * per_producer + i;
+                while( !queue.try_push( std::move(value) ) )
+                    std::this_thread::yield();
+            }
+        });
+    for( int c = 0; c < consumers; c++ )
+        threads.emplace_back( [&]() {
+            long value;
+            while( popped < producers * per_producer ) {
+                if( queue.try_pop( value ) ) {
+                    sum += value;
+                    popped++;
+                }
+                else
+                    std::this_thread::yield();
+            }
+        });
+    for( auto & t : threads )
+        t.join();
+
+    long n = producers * per_producer;
+    CHECK( popped == n );
+    CHECK( sum == n * (n + 1) / 2 );
+    CHECK( queue.size() == 0 );
+}
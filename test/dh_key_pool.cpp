@@ -0,0 +1,53 @@
+#include "protocols/dh_key_pool.hpp"
+#include <catch.hpp>
+#include <chrono>
+#include <thread>
+#include "random/xorshift.hpp"
+
+TEST_CASE( "Diffie-Hellman key pool", "[protocol]" ) {
+    // 4 generates the subgroup of order 1019 modulo 2039.
+    mpz_class prime = 2039, generator = 4, order = 1019;
+    rng::xorshift rng( 1, 2, 3, 4 );
+
+    SECTION( "The refill threads fill the pool" ) {
+        protocol::dh_key_pool pool( prime, generator, order, 30, 2, rng );
+        for( int i = 0; i < 500 && pool.stats().ready < 32; i++ )
+            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        auto stats = pool.stats();
+        REQUIRE( stats.capacity == 32 );
+        REQUIRE( stats.ready == 32 );
+        CHECK( stats.occupancy() == 1 );
+
+        for( int i = 0; i < 10; i++ ) {
+            protocol::diffie_hellman<> alice( prime, generator, order );
+            protocol::diffie_hellman<> bob( prime, generator, order );
+            pool.prepare( alice, rng );
+            bob.generate_private_number( rng );
+            CHECK( alice.get_public_number() ==
+                math::pow_mod( generator, alice.get_private_number(), prime ) );
+            CHECK( alice.get_private_number() >= 1 );
+            CHECK( alice.get_private_number() < order );
+            alice.set_partner_public_number( bob.get_public_number() );
+            bob.set_partner_public_number( alice.get_public_number() );
+            CHECK( alice.get_common_secret() == bob.get_common_secret() );
+        }
+        stats = pool.stats();
+        CHECK( stats.hits == 10 );
+        CHECK( stats.misses == 0 );
+        CHECK( stats.hit_rate() == 1 );
+        CHECK( stats.generated >= 32 );
+    }
+
+    SECTION( "Without refill threads, every request is a miss" ) {
+        protocol::dh_key_pool pool( prime, generator, order, 4, 0, rng );
+        protocol::diffie_hellman<> dh( prime, generator, order );
+        pool.prepare( dh, rng );
+        CHECK( dh.get_public_number() == math::pow_mod( generator, dh.get_private_number(), prime ) );
+        auto stats = pool.stats();
+        CHECK( stats.hits == 0 );
+        CHECK( stats.misses == 1 );
+        CHECK( stats.ready == 0 );
+        CHECK( stats.lowest_ready == 0 );
+        CHECK( stats.hit_rate() == 0 );
+    }
+}
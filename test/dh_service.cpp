@@ -0,0 +1,105 @@
+#include "protocols/dh_service.hpp"
+#include <catch.hpp>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unistd.h>
+#include "protocols/dh_load.hpp"
+#include "random/xorshift.hpp"
+
+TEST_CASE( "Diffie-Hellman service", "[protocol]" ) {
+    mpz_class prime = 1000000007, root = 5;
+    net::endpoint e = net::parse_endpoint(
+        "unix:/tmp/dh_service_test." + std::to_string( getpid() ) );
+
+    protocol::dh_server server( prime, root, 2 );
+    std::mutex mutex;
+    std::set< mpz_class > secrets;
+    server.on_exchange = [&]( const mpz_class &, const mpz_class & secret ) {
+        std::lock_guard< std::mutex > lock( mutex );
+        secrets.insert( secret );
+    };
+    server.listen( e );
+
+    rng::xorshift rng( 1, 2, 3, 4 );
+    std::thread loop( [&]( rng::xorshift server_rng ) {
+        server.run( server_rng );
+    }, rng::xorshift( 5, 6, 7, 8 ) );
+
+    SECTION( "Single exchanges agree on the secret" ) {
+        for( int i = 0; i < 10; i++ ) {
+            protocol::diffie_hellman<> dh( prime, root );
+            dh.generate_private_number( rng );
+            protocol::exchange( e, dh, prime );
+            std::lock_guard< std::mutex > lock( mutex );
+            CHECK( secrets.count( dh.get_common_secret() ) == 1 );
+        }
+    }
+
+    SECTION( "Concurrent sessions" ) {
+        protocol::load_options options;
+        options.sessions = 50;
+        options.handshakes = 300;
+        auto stats = protocol::generate_load( e, prime, root, options, rng );
+        CHECK( stats.handshakes == 300 );
+        CHECK( stats.failures == 0 );
+        CHECK( stats.latencies.size() == 300 );
+        CHECK( stats.percentile( 50 ) <= stats.percentile( 100 ) );
+        CHECK( server.stats().exchanges == 300 );
+    }
+
+    SECTION( "Invalid public numbers are rejected" ) {
+        int fd = net::connect_to( e );
+        CHECK( write( fd, "1\n", 2 ) == 2 );
+        char c;
+        CHECK( read( fd, &c, 1 ) == 0 );
+        close( fd );
+        CHECK( server.stats().rejected == 1 );
+    }
+
+    server.stop();
+    loop.join();
+}
+
+TEST_CASE( "Diffie-Hellman wire format", "[protocol]" ) {
+    mpz_class prime = 1000000007, n;
+    CHECK( protocol::encode_public_number( mpz_class(255) ) == "ff\n" );
+    CHECK( protocol::decode_public_number( "ff", prime, n ) );
+    CHECK( n == 255 );
+    CHECK_FALSE( protocol::decode_public_number( "", prime, n ) );
+    CHECK_FALSE( protocol::decode_public_number( "-5", prime, n ) );
+    CHECK_FALSE( protocol::decode_public_number( "1", prime, n ) );
+    CHECK_FALSE( protocol::decode_public_number( "3b9aca06", prime, n ) ); // p - 1
+    CHECK_FALSE( protocol::decode_public_number( "12 34", prime, n ) );
+}
+
+TEST_CASE( "Diffie-Hellman service in a subgroup of prime order", "[protocol]" ) {
+    // 4 generates the subgroup of order 1019 modulo 2039.
+    mpz_class prime = 2039, generator = 4, order = 1019;
+    net::endpoint e = net::parse_endpoint(
+        "unix:/tmp/dh_service_subgroup_test." + std::to_string( getpid() ) );
+
+    protocol::dh_server server( prime, generator, 1, order );
+    server.listen( e );
+    std::thread loop( [&]( rng::xorshift server_rng ) {
+        server.run( server_rng );
+    }, rng::xorshift( 5, 6, 7, 8 ) );
+
+    rng::xorshift rng( 1, 2, 3, 4 );
+    protocol::diffie_hellman<> dh( prime, generator, order );
+    dh.generate_private_number( rng );
+    protocol::exchange( e, dh, prime );
+    CHECK( math::pow_mod( dh.get_common_secret(), order, prime ) == 1 );
+
+    // 7 is not in the subgroup.
+    int fd = net::connect_to( e );
+    CHECK( write( fd, "7\n", 2 ) == 2 );
+    char c;
+    CHECK( read( fd, &c, 1 ) == 0 );
+    close( fd );
+    CHECK( server.stats().rejected == 1 );
+    CHECK( server.stats().exchanges == 1 );
+
+    server.stop();
+    loop.join();
+}
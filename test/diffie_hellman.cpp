@@ -23,3 +23,26 @@ TEST_CASE( "Diffie-Hellman key exchange", "[protocol]" ) {
     // Now, they share a common number.
     CHECK( alice.get_common_secret() == bob.get_common_secret() );
 }
+
+TEST_CASE( "Diffie-Hellman in a subgroup of prime order", "[protocol]" ) {
+    rng::xorshift rng( 1, 2, 3, 4 );
+    // 2039 = 2 * 1019 + 1; 4 generates the subgroup of order 1019.
+    protocol::diffie_hellman<> alice( 2039, 4, 1019 );
+    protocol::diffie_hellman<> bob( 2039, 4, 1019 );
+
+    for( int i = 0; i < 20; i++ ) {
+        alice.generate_private_number( rng );
+        bob.generate_private_number( rng );
+        CHECK( math::pow_mod( alice.get_public_number(), mpz_class(1019), mpz_class(2039) ) == 1 );
+        CHECK( alice.set_partner_public_number( bob.get_public_number(), true ) );
+        CHECK( bob.set_partner_public_number( alice.get_public_number(), true ) );
+        CHECK( alice.get_common_secret() == bob.get_common_secret() );
+    }
+
+    // 7 is a quadratic non-residue modulo 2039, so it is outside the subgroup.
+    CHECK_FALSE( alice.is_valid_public_number( 7 ) );
+    CHECK_FALSE( alice.set_partner_public_number( 7, true ) );
+    CHECK_FALSE( alice.is_valid_public_number( 1 ) );
+    CHECK_FALSE( alice.is_valid_public_number( 2038 ) );
+    CHECK( alice.set_partner_public_number( 7 ) ); // Not checked
+}
@@ -0,0 +1,24 @@
+#include "math/exponent_ring.hpp"
+#include <catch.hpp>
+#include <vector>
+
+TEST_CASE( "Exponent ring arithmetic", "[math]" ) {
+    math::exponent_ring<int> ring( 2016 ); // Order of the group modulo 2017
+    CHECK( ring.reduce( 2017 ) == 1 );
+    CHECK( ring.reduce( -1 ) == 2015 );
+    CHECK( ring.add( 2000, 20 ) == 4 );
+    CHECK( ring.multiply( 1000, 1000 ) == 1000000 % 2016 );
+    CHECK( ring.multiply( ring.inverse( 5 ), 5 ) == 1 );
+
+    std::vector<int> shares = {1500, 1999, 777, 1234};
+    int product = ring.product( shares.begin(), shares.end() );
+    CHECK( product == 1500LL * 1999 * 777 % 2016 * 1234 % 2016 );
+    CHECK( ring.product( shares.begin(), shares.begin() ) == 1 );
+
+    // The reduced exponent gives the same power.
+    mpz_class unreduced = 1;
+    for( int s : shares )
+        unreduced *= s;
+    CHECK( math::pow_mod( mpz_class(5), unreduced, mpz_class(2017) )
+        == math::pow_mod( mpz_class(5), mpz_class(product), mpz_class(2017) ) );
+}
@@ -0,0 +1,39 @@
+#include "math/fixed_base.hpp"
+#include <catch.hpp>
+#include <sstream>
+#include "random/gmp_adapter.hpp"
+#include "random/xorshift.hpp"
+
+TEST_CASE( "Fixed-base exponentiation", "[math]" ) {
+    for( unsigned w : {1, 3, 4} ) {
+        math::fixed_base<long long> f( 5, 2017, 11, w );
+        for( long long e = 0; e < 4000; e++ )
+            CHECK( f.pow( e ) == math::pow_mod( 5ll, e, 2017ll ) );
+    }
+
+    rng::xorshift rng( 1, 2, 3, 4 );
+    mpz_class n = rng::gmp_generate( rng, 521 ) | 1;
+    mpz_class g = rng::gmp_generate( rng, 521 ) % n;
+    math::fixed_base<mpz_class> f( g, n, 521 );
+    CHECK( f.matches( g, n ) );
+    CHECK_FALSE( f.matches( g + 1, n ) );
+    for( int i = 0; i < 50; i++ ) {
+        mpz_class e = rng::gmp_generate( rng, 521 );
+        CHECK( f.pow( e ) == math::pow_mod( g, e, n ) );
+    }
+    // Exponents too large for the table.
+    mpz_class e = rng::gmp_generate( rng, 600 );
+    CHECK( f.pow( e ) == math::pow_mod( g, e, n ) );
+
+    std::stringstream stream;
+    stream << f;
+    math::fixed_base<mpz_class> read;
+    REQUIRE( stream >> read );
+    CHECK( read.matches( g, n ) );
+    CHECK( read.window() == f.window() );
+    CHECK( read.pow( 12345 ) == math::pow_mod( g, mpz_class(12345), n ) );
+
+    stream.str( "5 2017 11" );
+    stream.clear();
+    CHECK_FALSE( stream >> read );
+}
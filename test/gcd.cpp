@@ -10,3 +10,57 @@ TEST_CASE( "Greatest Common Divisor", "[math]" ) {
     CHECK( math::gcd( 14, 49 ) == 7 );
     CHECK( math::gcd( 144, 89 ) == 1 );
 }
+
+TEST_CASE( "Binary GCD agrees with the euclidean algorithm", "[math]" ) {
+    for( long long a = -40; a <= 40; a++ )
+        for( long long b = 0; b <= 40; b++ ) {
+            long long e = a < 0 ? -a : a, f = b, tmp;
+            while( f != 0 ) {
+                tmp = e % f;
+                e = f;
+                f = tmp;
+            }
+            CHECK( math::gcd( a, b ) == e );
+            CHECK( math::gcd( int(a), int(b) ) == e );
+        }
+    CHECK( math::gcd( 1u << 31, 3u << 20 ) == 1u << 20 );
+}
+
+TEST_CASE( "GMP Greatest Common Divisor", "[math]" ) {
+    CHECK( math::gcd<mpz_class>( 144, 89 ) == 1 );
+    CHECK( math::gcd<mpz_class>( 14, 49 ) == 7 );
+    mpz_class big( "340282366920938463463374607431768211456" ); // 2^128
+    CHECK( math::gcd<mpz_class>( big, 3 * big / 4 ) == big / 4 );
+}
+
+TEST_CASE( "Extended Euclid and modular inverse", "[math]" ) {
+    for( int a = 1; a < 30; a++ )
+        for( int b = 1; b < 30; b++ ) {
+            auto d = math::extended_euclid( a, b );
+            CHECK( d.gcd == math::gcd( a, b ) );
+            CHECK( a * d.x + b * d.y == d.gcd );
+
+            auto e = math::extended_euclid<mpz_class>( a, b );
+            CHECK( e.gcd == d.gcd );
+            CHECK( a * e.x + b * e.y == e.gcd );
+        }
+
+    CHECK( math::modular_inverse( 3, 7 ) == 5 );
+    CHECK( math::modular_inverse( 10, 17 ) == 12 );
+    CHECK( math::modular_inverse<mpz_class>( 3, 7 ) == 5 );
+    CHECK( math::modular_inverse<mpz_class>( 10, 17 ) == 12 );
+}
+
+TEST_CASE( "Batch modular inverse", "[math]" ) {
+    std::vector<int> values = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    CHECK( math::batch_modular_inverse( values, 13 ).empty() );
+    for( int i = 0; i < 12; i++ )
+        CHECK( values[i] == math::modular_inverse( i + 1, 13 ) );
+
+    // 4, 6, 8 and 12 are not invertible modulo 10.
+    std::vector<mpz_class> mixed = {3, 4, 7, 6, 9, 8, 12, 13};
+    std::vector<std::size_t> failed = {1, 3, 5, 6};
+    std::vector<mpz_class> expected = {7, 4, 3, 6, 9, 8, 12, 7};
+    CHECK( math::batch_modular_inverse( mixed, mpz_class(10) ) == failed );
+    CHECK( mixed == expected );
+}
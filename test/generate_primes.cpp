@@ -0,0 +1,73 @@
+#include "math/generate_primes.hpp"
+#include <catch.hpp>
+#include "math/primitive_root.hpp"
+#include "random/xorshift.hpp"
+
+namespace {
+    mpz_class product( const math::factor::factor_list<mpz_class> & factors ) {
+        mpz_class r = 1;
+        for( const auto & pair : factors )
+            for( int i = 0; i < pair.second; i++ )
+                r *= pair.first;
+        return r;
+    }
+}
+
+TEST_CASE( "Safe primes", "[math]" ) {
+    rng::xorshift rng(1, 2, 3, 4);
+    for( int bits : {8, 32, 128} ) {
+        auto p = math::generate_safe_prime( rng, bits, 30 );
+        CHECK( mpz_sizeinbase( p.prime.get_mpz_t(), 2 ) == (std::size_t) bits );
+        CHECK( mpz_probab_prime_p( p.prime.get_mpz_t(), 30 ) != 0 );
+        REQUIRE( p.factors.size() == 2 );
+        CHECK( mpz_probab_prime_p( p.factors[1].first.get_mpz_t(), 30 ) != 0 );
+        CHECK( product( p.factors ) == p.prime - 1 );
+
+        auto root = math::primitive_root_modulo_p( p.prime, p.factors );
+        CHECK( math::is_primitive_root_modulo_p( root, p.prime, p.factors ) );
+    }
+}
+
+TEST_CASE( "Primes with factored p-1", "[math]" ) {
+    rng::xorshift rng(1, 2, 3, 4);
+    for( int bits : {24, 64, 256} ) {
+        auto p = math::generate_factored_prime( rng, bits, 16, 30 );
+        CHECK( mpz_sizeinbase( p.prime.get_mpz_t(), 2 ) == (std::size_t) bits );
+        CHECK( mpz_probab_prime_p( p.prime.get_mpz_t(), 30 ) != 0 );
+        CHECK( product( p.factors ) == p.prime - 1 );
+        for( const auto & pair : p.factors )
+            CHECK( mpz_probab_prime_p( pair.first.get_mpz_t(), 30 ) != 0 );
+
+        auto root = math::primitive_root_modulo_p( p.prime, p.factors );
+        CHECK( math::is_primitive_root_modulo_p( root, p.prime, p.factors ) );
+    }
+}
+
+TEST_CASE( "Primes with a subgroup of prime order", "[math]" ) {
+    rng::xorshift rng(1, 2, 3, 4);
+    for( auto sizes : {std::make_pair(32, 16), std::make_pair(256, 64), std::make_pair(512, 160)} ) {
+        auto p = math::generate_subgroup_prime( rng, sizes.first, sizes.second, 30 );
+        CHECK( mpz_sizeinbase( p.prime.get_mpz_t(), 2 ) == (std::size_t) sizes.first );
+        CHECK( mpz_sizeinbase( p.order.get_mpz_t(), 2 ) == (std::size_t) sizes.second );
+        CHECK( mpz_probab_prime_p( p.prime.get_mpz_t(), 30 ) != 0 );
+        CHECK( mpz_probab_prime_p( p.order.get_mpz_t(), 30 ) != 0 );
+        CHECK( (p.prime - 1) % p.order == 0 );
+        CHECK( p.generator != 1 );
+        CHECK( math::pow_mod( p.generator, p.order, p.prime ) == 1 );
+    }
+}
+
+TEST_CASE( "Primes with a subgroup of nearly the same size", "[math]" ) {
+    // Few values of k give p of the right size; some q admit none that work.
+    rng::xorshift rng(1, 2, 3, 4);
+    for( auto sizes : {std::make_pair(18, 16), std::make_pair(19, 16),
+            std::make_pair(66, 64), std::make_pair(67, 64)} )
+        for( int i = 0; i < 20; i++ ) {
+            auto p = math::generate_subgroup_prime( rng, sizes.first, sizes.second, 30 );
+            CHECK( mpz_sizeinbase( p.prime.get_mpz_t(), 2 ) == (std::size_t) sizes.first );
+            CHECK( mpz_sizeinbase( p.order.get_mpz_t(), 2 ) == (std::size_t) sizes.second );
+            CHECK( mpz_probab_prime_p( p.prime.get_mpz_t(), 30 ) != 0 );
+            CHECK( (p.prime - 1) % p.order == 0 );
+            CHECK( math::pow_mod( p.generator, p.order, p.prime ) == 1 );
+        }
+}
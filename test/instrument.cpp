@@ -0,0 +1,57 @@
+#include "instrument/instrument.hpp"
+#include <catch.hpp>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "math/algo.hpp"
+#include "random/xorshift.hpp"
+
+using instrument::counter;
+
+TEST_CASE( "Instrumentation counts only when enabled", "[instrument]" ) {
+    auto before = instrument::totals();
+    std::uint64_t expected = instrument::enabled ? 1 : 0;
+
+    math::pow_mod( 3, 1000, 1009 ); // 10 squarings and 6 multiplications
+    CHECK( instrument::totals()[counter::pow_mod] - before[counter::pow_mod] == expected );
+    CHECK( instrument::totals()[counter::multiplications] - before[counter::multiplications]
+        == 16 * expected );
+
+    rng::xorshift rng( 1, 2, 3, 4 );
+    for( int i = 0; i < 100; i++ )
+        rng();
+    CHECK( instrument::totals()[counter::rng_words] - before[counter::rng_words] == 100 * expected );
+
+    // Both exponents have 64 bits: the shared squarings alone are at least 60.
+    before = instrument::totals();
+    math::multi_pow_mod< long long >( {{3, 0x7fffffffffffffffLL}, {5, 0x7000000000000001LL}}, 1000003 );
+    std::uint64_t multiplications =
+        instrument::totals()[counter::multiplications] - before[counter::multiplications];
+    CHECK( multiplications >= 60 * expected );
+    CHECK( multiplications <= 2 * 128 * expected );
+
+    {
+        instrument::scoped_timer timer( instrument::timer::factor );
+    }
+    CHECK( instrument::totals().calls[std::size_t( instrument::timer::factor )]
+        - before.calls[std::size_t( instrument::timer::factor )] == expected );
+}
+
+TEST_CASE( "Instrumentation adds up the counts of every thread", "[instrument]" ) {
+    auto before = instrument::totals();
+    std::vector< std::thread > threads;
+    for( int t = 0; t < 4; t++ )
+        threads.emplace_back( []() {
+            for( int i = 0; i < 1000; i++ )
+                instrument::count( counter::gcd );
+        });
+    for( auto & t : threads )
+        t.join();
+    // The threads already exited; their counts must not be lost.
+    CHECK( instrument::totals()[counter::gcd] - before[counter::gcd]
+        == (instrument::enabled ? 4000u : 0u) );
+
+    std::ostringstream report;
+    instrument::report( report, instrument::totals() );
+    CHECK( (report.str().find( instrument::enabled ? "gcd: " : "disabled" ) != std::string::npos) );
+}
@@ -32,4 +32,43 @@ TEST_CASE( "math::subsets", "[math]" ) {
 
     subsets = {{1, 2, 3, 4}};
     CHECK( math::sorted_subsets(vec, 4) == subsets );
+
+    CHECK( math::subsets(vec, 5).empty() );
+    CHECK( math::subsets(vec, -1).empty() );
+}
+
+TEST_CASE( "math::binomial", "[math]" ) {
+    CHECK( math::binomial( 0, 0 ) == 1 );
+    CHECK( math::binomial( 4, 2 ) == 6 );
+    CHECK( math::binomial( 4, 5 ) == 0 );
+    CHECK( math::binomial( 4, -1 ) == 0 );
+    CHECK( math::binomial( 40, 5 ) == 658008 );
+    CHECK( math::binomial( 60, 30 ) == 118264581564861424ull );
+    // The last products exceed 64 bits, but the results fit.
+    CHECK( math::binomial( 64, 32 ) == 1832624140942590534ull );
+    CHECK( math::binomial( 66, 33 ) == 7219428434016265740ull );
+}
+
+TEST_CASE( "math::combination", "[math]" ) {
+    std::vector< std::vector<int> > expected =
+        {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}};
+    std::vector< std::vector<int> > obtained;
+    math::combination c( 4, 2 );
+    do {
+        CHECK( c.rank() == obtained.size() );
+        obtained.push_back( c.indexes() );
+    } while( c.next() );
+    CHECK( obtained == expected );
+    CHECK( c.indexes() == expected.back() );
+
+    for( std::uint64_t rank = 0; rank < math::binomial( 10, 4 ); rank++ ) {
+        math::combination d( 10, 4, rank );
+        CHECK( d.rank() == rank );
+        CHECK( math::combination::rank_of( 10, d.indexes() ) == rank );
+        if( rank > 0 ) {
+            math::combination e( 10, 4, rank - 1 );
+            e.next();
+            CHECK( e.indexes() == d.indexes() );
+        }
+    }
 }
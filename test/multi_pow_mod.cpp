@@ -0,0 +1,38 @@
+#include "math/algo.hpp"
+#include <catch.hpp>
+#include <algorithm>
+#include "random/gmp_adapter.hpp"
+#include "random/xorshift.hpp"
+
+TEST_CASE( "Multi-exponentiation agrees with separate exponentiations", "[math]" ) {
+    rng::xorshift rng( 1, 2, 3, 4 );
+    mpz_class n = rng::gmp_generate( rng, 512 ) | 1;
+
+    CHECK( math::multi_pow_mod< mpz_class >( {}, n ) == 1 );
+
+    // Straus is used for few terms, and Pippenger for many.
+    for( std::size_t k : {1, 2, 3, 5, 20, 300} )
+        for( int exponent_bits : {1, 17, 256} ) {
+            std::vector< std::pair< mpz_class, mpz_class > > terms;
+            mpz_class expected = 1;
+            for( std::size_t i = 0; i < k; i++ ) {
+                mpz_class base = rng::gmp_generate( rng, 600 ); // Larger than n
+                mpz_class exponent = i % 4 == 3 ? mpz_class(0)
+                    : rng::gmp_generate( rng, std::max( 1, exponent_bits - int(i % 3) ) );
+                terms.push_back( {base, exponent} );
+                expected = expected * math::pow_mod( base, exponent, n ) % n;
+            }
+            CHECK( math::multi_pow_mod( terms, n ) == expected );
+        }
+}
+
+TEST_CASE( "Multi-exponentiation with machine integers", "[math]" ) {
+    std::vector< std::pair< long long, long long > > terms;
+    long long n = 1000003, expected = 1;
+    for( long long i = 2; i < 60; i++ ) {
+        terms.push_back( {i * 7919 % n, i * i * 31} );
+        expected = expected * math::pow_mod( terms.back().first, terms.back().second, n ) % n;
+        CHECK( math::multi_pow_mod( terms, n ) == expected );
+    }
+    CHECK( math::multi_pow_mod< long long >( {{5, 0}, {7, 0}}, 1 ) == 0 );
+}
@@ -0,0 +1,74 @@
+#include "pinch/binary_noticeboard.hpp"
+#include <catch.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    // Writes the board to a fresh temporary file and returns its name.
+    template< typename T >
+    std::string write_temporary( const pinch::noticeboard<T> & board ) {
+        char name[] = "/tmp/pinch_binary_noticeboard_XXXXXX";
+        close( mkstemp( name ) );
+        std::ofstream file( name, std::ios::binary );
+        pinch::write_binary_noticeboard( file, board );
+        return name;
+    }
+}
+
+TEST_CASE( "binary noticeboard round trip", "[pinch]" ) {
+    pinch::noticeboard<mpz_class> board;
+    std::stringstream stream;
+    stream.str( "2 1000003\n"
+        "25 36 2 3 7\n"     // Groups out of order
+        "78 999999 2 1 3\n"
+        "11 12 2 1 7\n" );
+    stream >> board;
+
+    std::string name = write_temporary( board );
+    REQUIRE( pinch::binary::is_binary_noticeboard( name ) );
+    {
+        pinch::mapped_noticeboard<mpz_class> mapped( name );
+        CHECK( mapped.generator == 2 );
+        CHECK( mapped.prime_modulo == 1000003 );
+        CHECK( mapped.size() == 3 );
+        CHECK( mapped.users() == std::vector<int>({1, 3, 7}) );
+        CHECK( mapped.threshold() == 2 );
+
+        auto data = mapped.retrieve_data( {1, 3} );
+        CHECK( data.group_generator == 78 );
+        CHECK( data.group_value == 999999 );
+        CHECK( mapped.retrieve_data( {3, 7} ).group_generator == 25 );
+        CHECK( mapped.retrieve_data( {1, 7} ).group_value == 12 );
+        REQUIRE_THROWS_AS( mapped.retrieve_data( {1, 2} ), std::out_of_range );
+        REQUIRE_THROWS_AS( mapped.retrieve_data( {3, 1} ), std::out_of_range );
+        REQUIRE_THROWS_AS( mapped.retrieve_data( {1, 3, 7} ), std::out_of_range );
+
+        auto loaded = mapped.load();
+        REQUIRE( loaded.groups.size() == 3 );
+        CHECK( loaded.groups[0].group == std::vector<int>({1, 3}) );
+        CHECK( loaded.groups[1].group == std::vector<int>({1, 7}) );
+        CHECK( loaded.groups[2].group == std::vector<int>({3, 7}) );
+    }
+    std::remove( name.c_str() );
+}
+
+TEST_CASE( "binary noticeboard with missing groups", "[pinch]" ) {
+    pinch::noticeboard<int> board;
+    board.generator = 2;
+    board.prime_modulo = 19;
+    board.groups.push_back( {5, 6, {1, 2}} );
+    board.groups.push_back( {7, 8, {3, 4}} );
+
+    std::string name = write_temporary( board );
+    {
+        pinch::mapped_noticeboard<int> mapped( name );
+        CHECK( mapped.retrieve_data( {1, 2} ).group_value == 6 );
+        CHECK( mapped.retrieve_data( {3, 4} ).group_value == 8 );
+        REQUIRE_THROWS_AS( mapped.retrieve_data( {1, 3} ), std::out_of_range );
+    }
+    std::remove( name.c_str() );
+
+    REQUIRE_THROWS_AS( pinch::mapped_noticeboard<int>( "/nonexistent/board" ),
+        std::runtime_error );
+}
@@ -0,0 +1,78 @@
+#include "pinch/dealer_database.hpp"
+#include <catch.hpp>
+#include <cstdio>
+#include "random/xorshift.hpp"
+
+TEST_CASE( "pinch::dealer_information bulk issuance", "[pinch]" ) {
+    rng::xorshift rng(1, 2, 3, 4);
+    pinch::dealer_information<mpz_class> dealer;
+    dealer.prime = 2017;
+    dealer.generator = 5;
+    dealer.new_share( rng );
+
+    auto issued = dealer.issue_shares( 1000, rng, 4 );
+    REQUIRE( issued.size() == 1000 );
+    REQUIRE( dealer.valid_shares.size() == 1001 );
+    CHECK( dealer.last_id == 1001 );
+    for( int i = 0; i < 1001; i++ ) {
+        CHECK( dealer.valid_shares[i].id == i + 1 );
+        CHECK( dealer.valid_shares[i].share < 2017 );
+    }
+    CHECK( issued[0].id == 2 );
+
+    CHECK( dealer.remove_share( 500 ) );
+    CHECK_FALSE( dealer.remove_share( 500 ) );
+    CHECK( dealer.share_index( 501 ) == 499 );
+}
+
+TEST_CASE( "pinch::dealer_database", "[pinch]" ) {
+    rng::xorshift rng(1, 2, 3, 4);
+    pinch::dealer_information<mpz_class> dealer;
+    dealer.prime = 1000003;
+    dealer.generator = 2;
+    dealer.issue_shares( 100, rng );
+
+    char name[] = "/tmp/pinch_dealer_database_XXXXXX";
+    close( mkstemp( name ) );
+    pinch::dealer_database<mpz_class>::create( name, dealer );
+    REQUIRE( pinch::binary::is_dealer_database( name ) );
+
+    {
+        pinch::dealer_database<mpz_class> db( name );
+        CHECK( db.size() == 100 );
+        auto header = db.header();
+        CHECK( header.prime == 1000003 );
+        CHECK( header.generator == 2 );
+        CHECK( header.last_id == 100 );
+        CHECK( header.valid_shares.empty() );
+
+        CHECK( db.remove( 1 ) );
+        CHECK( db.remove( 57 ) );
+        CHECK( db.remove( 100 ) );
+        CHECK_FALSE( db.remove( 57 ) );
+        CHECK_FALSE( db.remove( 101 ) );
+
+        auto added = header.issue_shares( 3, rng );
+        db.append( added );
+        CHECK( db.size() == 103 );
+        CHECK_THROWS_AS( db.append( added ), std::invalid_argument );
+    }
+
+    // Reopen and compare with the same operations done in memory.
+    dealer.remove_share( 1 );
+    dealer.remove_share( 57 );
+    dealer.remove_share( 100 );
+    pinch::dealer_database<mpz_class> db( name );
+    auto loaded = db.load();
+    CHECK( loaded.last_id == 103 );
+    REQUIRE( loaded.valid_shares.size() == 100 );
+    for( std::size_t i = 0; i < 97; i++ ) {
+        CHECK( loaded.valid_shares[i].id == dealer.valid_shares[i].id );
+        CHECK( loaded.valid_shares[i].share == dealer.valid_shares[i].share );
+    }
+    CHECK( loaded.valid_shares[97].id == 101 );
+    CHECK( loaded.valid_shares[99].id == 103 );
+    std::remove( name );
+
+    CHECK_THROWS_AS( pinch::dealer_database<mpz_class>( name ), std::runtime_error );
+}
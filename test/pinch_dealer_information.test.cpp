@@ -1,6 +1,7 @@
 #include "pinch/dealer_information.hpp"
 #include <catch.hpp>
 #include <sstream>
+#include "random/xorshift.hpp"
 
 TEST_CASE( "pinch::dealer_information input and output", "[pinch]" ) {
     std::stringstream stream;
@@ -21,3 +22,78 @@ TEST_CASE( "pinch::dealer_information input and output", "[pinch]" ) {
     stream << dealer_information;
     CHECK( stream.str() == "2 17 3\n1 8\n2 7\n" );
 }
+
+TEST_CASE( "pinch::dealer_information noticeboard generation", "[pinch]" ) {
+    rng::xorshift rng(1, 2, 3, 4);
+    pinch::dealer_information<mpz_class> dealer;
+    dealer.prime = 2017;
+    dealer.generator = 5;
+    for( int i = 0; i < 6; i++ )
+        dealer.new_share( rng );
+
+    mpz_class secret = 1234;
+    for( unsigned threads : {1, 4} ) {
+        auto board = dealer.generate_noticeboard( secret, 3, rng, threads );
+        REQUIRE( board.groups.size() == 20 );
+        for( std::size_t i = 1; i < board.groups.size(); i++ )
+            CHECK( board.groups[i-1].group < board.groups[i].group );
+
+        // Reconstruct the secret directly from the shares of each group.
+        for( const auto & data : board.groups ) {
+            mpz_class power = 1;
+            for( int id : data.group )
+                power *= dealer.valid_shares[id - 1].share;
+            mpz_class V_X = math::pow_mod( data.group_generator, power, dealer.prime );
+            mpz_class f_V_X = math::pow_mod( dealer.generator, V_X, dealer.prime );
+            CHECK( (data.group_value + f_V_X) % dealer.prime == secret );
+        }
+    }
+}
+
+TEST_CASE( "pinch::dealer_information incremental noticeboard", "[pinch]" ) {
+    rng::xorshift rng(1, 2, 3, 4);
+    pinch::dealer_information<mpz_class> dealer;
+    dealer.prime = 2017;
+    dealer.generator = 5;
+    for( int i = 0; i < 5; i++ )
+        dealer.new_share( rng );
+
+    mpz_class secret = 1234;
+    auto board = dealer.generate_noticeboard( secret, 3, rng );
+    REQUIRE( board.groups.size() == 10 );
+
+    int id6 = dealer.new_share( rng ).id;
+    int id7 = dealer.new_share( rng ).id;
+    CHECK( dealer.extend_noticeboard( board, secret, 3, {id6, id7}, rng, 2 ) == 25 );
+    CHECK( board.groups.size() == 35 ); // C(7, 3)
+
+    CHECK( dealer.prune_noticeboard( board, 2 ) == 15 ); // C(6, 2)
+    dealer.remove_share( 2 );
+    CHECK( board.groups.size() == 20 ); // C(6, 3)
+
+    auto full = dealer.generate_noticeboard( secret, 3, rng );
+    REQUIRE( full.groups.size() == board.groups.size() );
+    for( std::size_t i = 0; i < full.groups.size(); i++ ) {
+        const auto & data = board.groups[i];
+        CHECK( data.group == full.groups[i].group );
+        CHECK( &board.retrieve_data( data.group ) == &data );
+
+        mpz_class power = 1;
+        for( int id : data.group )
+            power *= dealer.valid_shares[dealer.share_index( id )].share;
+        mpz_class V_X = math::pow_mod( data.group_generator, power, dealer.prime );
+        mpz_class f_V_X = math::pow_mod( dealer.generator, V_X, dealer.prime );
+        CHECK( (data.group_value + f_V_X) % dealer.prime == secret );
+    }
+
+    REQUIRE_THROWS_AS( dealer.extend_noticeboard( board, mpz_class(4321), 3, {}, rng ),
+        std::invalid_argument );
+
+    // The board is checked before anything is added.
+    std::size_t size = board.groups.size();
+    REQUIRE_NOTHROW( dealer.check_noticeboard( board, secret, 3 ) );
+    REQUIRE_THROWS_AS( dealer.check_noticeboard( board, secret, 2 ), std::invalid_argument );
+    REQUIRE_THROWS_AS( dealer.extend_noticeboard( board, secret, 4, {}, rng ),
+        std::invalid_argument );
+    CHECK( board.groups.size() == size );
+}
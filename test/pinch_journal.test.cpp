@@ -0,0 +1,20 @@
+#include "pinch/journal.hpp"
+#include <catch.hpp>
+#include <sstream>
+
+TEST_CASE( "pinch::journal_entry input and output", "[pinch]" ) {
+    std::stringstream stream;
+    pinch::journal_entry entry;
+
+    stream.str( "1700000000 remove 7" );
+    CHECK( stream >> entry );
+    CHECK( entry.time == 1700000000 );
+    CHECK( entry.action == "remove" );
+    CHECK( entry.argument == 7 );
+
+    entry = {1700000001, "add", 8};
+    stream.str("");
+    stream.clear();
+    stream << entry;
+    CHECK( stream.str() == "1700000001 add 8" );
+}
@@ -75,3 +75,41 @@ TEST_CASE( "noticeboard retrieval", "[pinch]" ) {
 
     REQUIRE_THROWS_AS( data = board.retrieve_data( {2, 3} ), std::out_of_range );
 }
+
+TEST_CASE( "noticeboard retrieval after direct changes", "[pinch]" ) {
+    pinch::noticeboard<int> board;
+    board.groups.push_back( {25, 36, {1, 2}} );
+    board.groups.push_back( {78, 89, {1, 3}} );
+
+    // Stale index; falls back to the linear scan.
+    CHECK( board.retrieve_data( {1, 3} ).group_generator == 78 );
+
+    board.build_index();
+    CHECK( board.retrieve_data( {1, 2} ).group_generator == 25 );
+    CHECK( board.retrieve_data( {1, 3} ).group_generator == 78 );
+    REQUIRE_THROWS_AS( board.retrieve_data( {2, 3} ), std::out_of_range );
+    REQUIRE_THROWS_AS( board.retrieve_data( {1} ), std::out_of_range );
+}
+
+TEST_CASE( "noticeboard retrieval after replacing a group", "[pinch]" ) {
+    pinch::noticeboard<int> board;
+    board.groups.push_back( {25, 36, {1, 2}} );
+    board.groups.push_back( {78, 89, {1, 3}} );
+    board.build_index();
+
+    board.replace_group( 1, {47, 58, {2, 3}} );
+    CHECK( board.index_current() );
+    CHECK( board.retrieve_data( {2, 3} ).group_generator == 47 );
+    CHECK( board.retrieve_data( {1, 2} ).group_generator == 25 );
+    REQUIRE_THROWS_AS( board.retrieve_data( {1, 3} ), std::out_of_range );
+
+    // Direct changes in place need a new index.
+    board.groups[1] = {78, 89, {1, 3}};
+    board.build_index();
+    CHECK( board.retrieve_data( {1, 3} ).group_generator == 78 );
+    REQUIRE_THROWS_AS( board.retrieve_data( {2, 3} ), std::out_of_range );
+
+    board.groups.push_back( {47, 58, {2, 3}} );
+    CHECK_FALSE( board.index_current() );
+    CHECK( board.retrieve_data( {2, 3} ).group_generator == 47 );
+}
@@ -0,0 +1,36 @@
+#include "pinch/reconstruction.hpp"
+#include <catch.hpp>
+#include "pinch/dealer_information.hpp"
+#include "random/xorshift.hpp"
+
+TEST_CASE( "pinch::reconstruction_coordinator", "[pinch]" ) {
+    rng::xorshift rng(1, 2, 3, 4);
+    pinch::dealer_information<mpz_class> dealer;
+    dealer.prime = 2017;
+    dealer.generator = 5;
+    for( int i = 0; i < 6; i++ )
+        dealer.new_share( rng );
+
+    mpz_class secret = 1234;
+    auto board = dealer.generate_noticeboard( secret, 3, rng );
+
+    std::vector< std::vector<int> > groups;
+    for( int round = 0; round < 3; round++ )
+        for( const auto & data : board.groups )
+            groups.push_back( data.group );
+
+    pinch::reconstruction_coordinator<mpz_class> coordinator( dealer.valid_shares );
+    for( std::size_t window : {0, 1, 7} ) {
+        pinch::reconstruction_stats stats;
+        auto secrets = coordinator.reconstruct( board, groups, rng, window, &stats );
+        REQUIRE( secrets.size() == 60 );
+        for( const mpz_class & s : secrets )
+            CHECK( s == secret );
+        CHECK( stats.reconstructions == 60 );
+    }
+
+    // Groups with less than threshold users are not in the board.
+    groups.push_back( {1, 2} );
+    CHECK_THROWS_AS( coordinator.reconstruct( board, groups, rng ), std::out_of_range );
+    CHECK_THROWS_AS( coordinator.reconstruct( board, {{1, 9, 10}}, rng ), std::out_of_range );
+}
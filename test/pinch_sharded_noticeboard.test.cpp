@@ -0,0 +1,94 @@
+#include "pinch/sharded_noticeboard.hpp"
+#include <catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "pinch/dealer_information.hpp"
+#include "random/xorshift.hpp"
+
+TEST_CASE( "pinch::noticeboard_manifest", "[pinch]" ) {
+    auto manifest = pinch::make_manifest( 7, 3, 4, "board" );
+    CHECK( manifest.total == 35 );
+    REQUIRE( manifest.shards.size() == 4 );
+    CHECK( manifest.shards[0].first_rank == 0 );
+    CHECK( manifest.shards[0].count == 9 );
+    CHECK( manifest.shards[3].first_rank == 27 );
+    CHECK( manifest.shards[3].count == 8 );
+    CHECK( manifest.shards[2].file == "board.2" );
+
+    CHECK( pinch::make_manifest( 4, 3, 10, "board" ).shards.size() == 4 );
+
+    std::stringstream stream;
+    stream << manifest;
+    pinch::noticeboard_manifest read;
+    REQUIRE( stream >> read );
+    CHECK( read.total == 35 );
+    CHECK( read.shards[1].first_rank == 9 );
+    CHECK( read.shards[1].file == "board.1" );
+
+    stream.str( "2 1000003\n" );
+    stream.clear();
+    CHECK_FALSE( stream >> read );
+}
+
+TEST_CASE( "pinch::sharded_noticeboard", "[pinch]" ) {
+    rng::xorshift rng(1, 2, 3, 4);
+    pinch::dealer_information<mpz_class> dealer;
+    dealer.prime = 2017;
+    dealer.generator = 5;
+    for( int i = 0; i < 7; i++ )
+        dealer.new_share( rng );
+    dealer.remove_share( 3 ); // IDs need not be contiguous
+
+    char name[] = "/tmp/pinch_sharded_noticeboard_XXXXXX";
+    close( mkstemp( name ) );
+    std::string manifest_file = name;
+    auto manifest = pinch::make_manifest( 6, 3, 3,
+        manifest_file.substr( manifest_file.rfind( '/' ) + 1 ) );
+
+    mpz_class secret = 1234;
+    for( std::size_t i = 0; i < manifest.shards.size(); i++ ) {
+        std::ofstream file( manifest_file + '.' + std::to_string(i), std::ios::binary );
+        const auto & shard = manifest.shards[i];
+        // Small batches, so that a shard is written in several pieces.
+        dealer.write_noticeboard_shard( file, secret, 3, shard.first_rank, shard.count,
+            rng, 2, nullptr, 10000, 3 );
+    }
+    {
+        std::ofstream file( manifest_file );
+        file << manifest;
+    }
+    REQUIRE( pinch::is_noticeboard_manifest( manifest_file ) );
+
+    pinch::sharded_noticeboard<mpz_class> board( manifest_file );
+    CHECK( board.size() == 20 );
+    CHECK( board.shard_count() == 3 );
+    CHECK( board.prime_modulo == 2017 );
+
+    math::combination c( 6, 3 );
+    do {
+        std::vector<int> group;
+        mpz_class power = 1;
+        for( int index : c.indexes() ) {
+            group.push_back( dealer.valid_shares[index].id );
+            power *= dealer.valid_shares[index].share;
+        }
+        auto data = board.retrieve_data( group );
+        CHECK( data.group == group );
+        mpz_class V_X = math::pow_mod( data.group_generator, power, dealer.prime );
+        mpz_class f_V_X = math::pow_mod( dealer.generator, V_X, dealer.prime );
+        CHECK( (data.group_value + f_V_X) % dealer.prime == secret );
+    } while( c.next() );
+
+    CHECK_THROWS_AS( board.retrieve_data( {1, 2, 3} ), std::out_of_range );
+    CHECK_THROWS_AS( board.retrieve_data( {1, 2} ), std::out_of_range );
+
+    // A missing shard is detected when the manifest is opened.
+    std::remove( (manifest_file + ".1").c_str() );
+    CHECK_THROWS_AS( pinch::sharded_noticeboard<mpz_class>( manifest_file ),
+        std::runtime_error );
+
+    std::remove( manifest_file.c_str() );
+    std::remove( (manifest_file + ".0").c_str() );
+    std::remove( (manifest_file + ".2").c_str() );
+}
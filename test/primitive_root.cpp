@@ -84,3 +84,35 @@ TEST_CASE( "Random primitive roots", "[math]" ) {
     }
     CHECK( roots17.size() == 0 );
 }
+
+TEST_CASE( "Primitive root generator", "[math]" ) {
+    auto factors = math::factor::factor(70);
+    std::vector<int> sequential, parallel;
+
+    math::primitive_root_generator<int> generator( 71, 7, factors );
+    int root;
+    while( generator.next( root ) )
+        sequential.push_back( root );
+    CHECK( sequential.size() == 24 );
+    CHECK( sequential[0] == 7 ); // 7^1
+
+    // Only the exponents 11, 13, 17 and 19 lie in [10, 20] and are coprime with 70.
+    math::primitive_root_generator<int> range( 71, 7, factors, 10, 20 );
+    std::vector<int> expected = {
+        math::pow_mod( 7, 11, 71 ),
+        math::pow_mod( 7, 13, 71 ),
+        math::pow_mod( 7, 17, 71 ),
+        math::pow_mod( 7, 19, 71 ),
+    };
+    std::vector<int> obtained;
+    while( range.next( root ) )
+        obtained.push_back( root );
+    CHECK( obtained == expected );
+
+    math::enumerate_primitive_roots( 71, 7, factors, 3, 4,
+        [&]( const std::vector<int> & block ) {
+            parallel.insert( parallel.end(), block.begin(), block.end() );
+        }
+    );
+    CHECK( parallel == sequential );
+}
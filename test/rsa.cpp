@@ -0,0 +1,38 @@
+#include "protocols/rsa.hpp"
+#include <catch.hpp>
+#include "random/gmp_adapter.hpp"
+#include "random/xorshift.hpp"
+
+TEST_CASE( "Exponentiation by a machine word", "[math]" ) {
+    for( unsigned long e : {0ul, 1ul, 2ul, 3ul, 17ul, 65537ul, 4294967297ul} )
+        CHECK( math::pow_mod_word( 1234567ll, e, 1000003ll )
+            == math::pow_mod( 1234567ll, (long long) e, 1000003ll ) );
+
+    unsigned long word;
+    CHECK( math::to_word( mpz_class(65537), word ) );
+    CHECK( word == 65537 );
+    CHECK_FALSE( math::to_word( mpz_class(-1), word ) );
+    mpz_class big = 1;
+    big <<= 100;
+    CHECK_FALSE( math::to_word( big, word ) );
+}
+
+TEST_CASE( "RSA with a small public exponent", "[rsa]" ) {
+    rng::xorshift rng( 1, 2, 3, 4 );
+    for( unsigned long e : {3ul, 65537ul} ) {
+        auto primes = rsa::generate_key_primes( rng, 256, mpz_class(e) );
+        mpz_class p = primes.first, q = primes.second;
+        CHECK( p != q );
+        CHECK( math::gcd( mpz_class(p - 1), mpz_class(e) ) == 1 );
+        CHECK( math::gcd( mpz_class(q - 1), mpz_class(e) ) == 1 );
+
+        auto public_key = rsa::build_public_key( p, q, mpz_class(e) );
+        auto private_key = rsa::build_private_key( p, q, mpz_class(e) );
+        for( int i = 0; i < 20; i++ ) {
+            mpz_class x = rng::gmp_generate( rng, 200 );
+            mpz_class y = public_key.encrypt( x );
+            CHECK( y == math::pow_mod( x, public_key.b, public_key.n ) );
+            CHECK( private_key.decrypt( y ) == x );
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#include "protocols/rsa_stream.hpp"
+#include <catch.hpp>
+#include <sstream>
+#include <string>
+#include "random/xorshift.hpp"
+
+TEST_CASE( "RSA byte stream encryption", "[rsa]" ) {
+    rng::xorshift rng( 1, 2, 3, 4 );
+    auto primes = rsa::generate_key_primes( rng, 128, mpz_class(65537) );
+    auto public_key = rsa::build_public_key( primes.first, primes.second, mpz_class(65537) );
+    auto private_key = rsa::build_private_key( primes.first, primes.second, mpz_class(65537) );
+    std::size_t d = rsa::block_bytes( public_key.n ), w = rsa::cipher_bytes( public_key.n );
+    CHECK( d == 15 );
+    CHECK( w == 16 );
+
+    // Leading zeros, full and partial blocks, and several batches.
+    for( std::size_t size : {0, 1, 15, 16, 30, 1000} ) {
+        std::string plaintext( size, '\0' );
+        for( std::size_t i = size / 2; i < size; i++ )
+            plaintext[i] = rng();
+
+        std::stringstream in( plaintext ), cipher, out;
+        std::size_t blocks = rsa::encrypt_stream( in, cipher, public_key, 3, 4 );
+        CHECK( blocks == (size + d - 1) / d );
+        CHECK( cipher.str().size() == blocks * w );
+
+        CHECK( rsa::decrypt_stream( cipher, out, private_key, 2, 5 ) == blocks );
+        CHECK( out.str() == plaintext );
+    }
+
+    std::stringstream truncated( std::string( w + 1, 'x' ) ), out;
+    CHECK_THROWS_AS( rsa::decrypt_stream( truncated, out, private_key ), std::runtime_error );
+}
@@ -0,0 +1,80 @@
+#include "protocols/x25519.hpp"
+#include <catch.hpp>
+#include "random/xorshift.hpp"
+
+namespace {
+    protocol::x25519_key key( const std::string & hex ) {
+        protocol::x25519_key k;
+        REQUIRE( protocol::from_hex( hex, k ) );
+        return k;
+    }
+}
+
+TEST_CASE( "X25519 test vectors of RFC 7748", "[protocol]" ) {
+    using protocol::to_hex;
+
+    SECTION( "Section 5.2" ) {
+        CHECK( to_hex( protocol::x25519_scalarmult(
+            key( "a546e36bf0527c9d3b16154b82465edd62144c0ac1fc5a18506a2244ba449ac4" ),
+            key( "e6db6867583030db3594c1a424b15f7c726624ec26b3353b10a903a6d0ab1c4c" ) ) )
+            == "c3da55379de9c6908e94ea4df28d084f32eccf03491c71f754b4075577a28552" );
+        // The most significant bit of u must be ignored.
+        CHECK( to_hex( protocol::x25519_scalarmult(
+            key( "4b66e9d4d1b4673c5ad22691957d6af5c11b6421e0ea01d42ca4169e7918ba0d" ),
+            key( "e5210f12786811d3f4b7959d0538ae2c31dbe7106fc03c3efc4cd549c715a493" ) ) )
+            == "95cbde9476e8907d7aade45cb4b873f88b595a68799fa152e6f8f7647aac7957" );
+    }
+
+    SECTION( "Iterated scalar multiplication" ) {
+        protocol::x25519_key k = {{9}}, u = {{9}};
+        for( int i = 1; i <= 1000; i++ ) {
+            protocol::x25519_key r = protocol::x25519_scalarmult( k, u );
+            u = k;
+            k = r;
+            if( i == 1 )
+                CHECK( to_hex( k ) ==
+                    "422c8e7a6227d7bca1350b3e2bb7279f7897b87bb6854b783c60e80311ae3079" );
+        }
+        CHECK( to_hex( k ) == "684cf59ba83309552800ef566f2f4d3c1c3887c49360e3875f2eb94d99532c51" );
+    }
+
+    SECTION( "Section 6.1" ) {
+        protocol::x25519 alice, bob;
+        alice.set_private_number(
+            key( "77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a" ) );
+        bob.set_private_number(
+            key( "5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb" ) );
+        CHECK( to_hex( alice.get_public_number() ) ==
+            "8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a" );
+        CHECK( to_hex( bob.get_public_number() ) ==
+            "de9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f" );
+        CHECK( alice.set_partner_public_number( bob.get_public_number() ) );
+        CHECK( bob.set_partner_public_number( alice.get_public_number() ) );
+        CHECK( to_hex( alice.get_common_secret() ) ==
+            "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742" );
+        CHECK( bob.get_common_secret() == alice.get_common_secret() );
+    }
+}
+
+TEST_CASE( "X25519 key exchange", "[protocol]" ) {
+    rng::xorshift rng( 1, 2, 3, 4 );
+    for( int i = 0; i < 10; i++ ) {
+        protocol::x25519 alice, bob;
+        alice.generate_private_number( rng );
+        bob.generate_private_number( rng );
+        CHECK( alice.set_partner_public_number( bob.get_public_number() ) );
+        CHECK( bob.set_partner_public_number( alice.get_public_number() ) );
+        CHECK( alice.get_common_secret() == bob.get_common_secret() );
+    }
+
+    // u = 0 and u = 1 have small order; the secret is zero.
+    protocol::x25519 alice;
+    alice.generate_private_number( rng );
+    protocol::x25519_key zero = {{0}}, one = {{1}};
+    CHECK_FALSE( alice.set_partner_public_number( zero ) );
+    CHECK_FALSE( alice.set_partner_public_number( one ) );
+
+    protocol::x25519_key k;
+    CHECK_FALSE( protocol::from_hex( "12", k ) );
+    CHECK_FALSE( protocol::from_hex( std::string( 63, '0' ) + "g", k ) );
+}
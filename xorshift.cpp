@@ -30,6 +30,10 @@ namespace command_line {
 "    Default: x and z gets the lowest 32 bits of current time,\n"
 "    y and w gets the highest 32 bits.\n"
 "\n"
+"--stats\n"
+"    Writes the instrumentation counters to the standard error at exit\n"
+"    (see instrument/instrument.hpp; needs a build with -DINSTRUMENT).\n"
+"\n"
 "--help\n"
 "    Displays this help and quit.\n"
 ;
@@ -38,6 +42,7 @@ namespace command_line {
 #include <iostream>
 #include <gmpxx.h>
 #include "cmdline/args.hpp"
+#include "instrument/instrument.hpp"
 #include "random/xorshift.hpp"
 
 rng::xorshift global_rng;
@@ -79,6 +84,10 @@ namespace command_line {
                 args >> global_rng.w;
                 continue;
             }
+            if( arg == "--stats" ) {
+                instrument::report_at_exit();
+                continue;
+            }
             if( arg == "--help" ) {
                 std::cout << "Usage: " << args.program_name() << help_message;
                 std::exit( 0 );